@@ -28,6 +28,8 @@
  * $Id: crt0iz.c 3714 2005-04-02 13:13:53Z vrokas $
  */
 
+#include "ram_layout.h"
+
 extern int stack;
 extern int stack_end;
 
@@ -39,12 +41,54 @@ extern int FSR0H;
 extern int TABLAT;
 extern int POSTINC0;
 extern int POSTDEC0;
+extern int WREG;
 
 #if 1
 /* global variable for forcing gplink to add _cinit section */
 char __uflags = 0;
 #endif
 
+/*
+ *  RAM layout for the 18F8520, which has 2k of RAM at 0x000 - 0x7ff.
+ *  Addresses 0x800 - 0xf5f are not implemented, and 0xf60 - 0xfff are
+ *  SFRs, so there is no point clearing anything above 0x7ff.
+ *
+ *  NOINIT_BASE through 0x7f3 is the noinit section (see vexsdcc.lkr),
+ *  which is never cleared, so variables placed there survive a reset.
+ *  0x7f4 - 0x7ff is reserved for the debugger.  NOINIT_BASE and the
+ *  stack location come from ram_layout.h.
+ */
+
+/*
+ *  Define FAST_BOOT (e.g. CFLAGS += -DFAST_BOOT) to clear RAM with an
+ *  unrolled loop that also skips the stack page, which needs no
+ *  clearing since nothing has been pushed yet.  Nothing else can be
+ *  there, since the page is PROTECTED in vexsdcc.lkr.
+ *
+ *  Cycles from reset to _do_cinit(), counted from the instructions
+ *  below (1 cycle each, 2 for taken branches, call and return):
+ *
+ *      Original clear of 0xeff down to 0x000:   3840 * 4 = 15360
+ *      Default clear of 0x7bf down to 0x000:    1984 * 4 =  7936
+ *      FAST_BOOT, skipping 0x200 - 0x2ff:  (64 + 152) * 11 =  2376
+ *
+ *  To measure on a real build, load firmware.cod into gpsim and
+ *  break on main:
+ *
+ *      gpsim -p p18f8520 -s firmware.cod
+ *      break e _main
+ *      run
+ *      cycles
+ */
+#define CLEAR_UNROLL    8
+
+#if (SDCC_STACK_ADDR % CLEAR_UNROLL) != 0 || \
+    (SDCC_STACK_SIZE % CLEAR_UNROLL) != 0 || \
+    (NOINIT_BASE % CLEAR_UNROLL) != 0 || \
+    (SDCC_STACK_ADDR + SDCC_STACK_SIZE > NOINIT_BASE)
+#error "FAST_BOOT needs the stack and NOINIT_BASE on 8-byte boundaries"
+#endif
+
 /* external reference to the user's main routine */
 extern void main (void);
 
@@ -86,12 +130,40 @@ void _startup (void) __naked
   __endasm ;
     
   /* cleanup the RAM */
+#ifdef FAST_BOOT
+  __asm
+    /* 0x000 up to the stack, 8 bytes per pass */
+    lfsr 0, 0x000
+    movlw SDCC_STACK_ADDR / CLEAR_UNROLL
+    call fast_clear
+    
+    /* Above the stack up to the noinit section */
+    lfsr 0, SDCC_STACK_ADDR + SDCC_STACK_SIZE
+    movlw (NOINIT_BASE - SDCC_STACK_ADDR - SDCC_STACK_SIZE) / CLEAR_UNROLL
+    call fast_clear
+    bra clear_done
+
+fast_clear:
+    clrf _POSTINC0
+    clrf _POSTINC0
+    clrf _POSTINC0
+    clrf _POSTINC0
+    clrf _POSTINC0
+    clrf _POSTINC0
+    clrf _POSTINC0
+    clrf _POSTINC0
+    decfsz _WREG, f, 0
+    bra fast_clear
+    return
+
+clear_done:
+  __endasm ;
+#else
   __asm
-    /* load FSR0 with top of RAM memory */
-	; movlw 0xff
-	; movwf _FSR0L, 0
-    setf _FSR0L
-    movlw 0x0e
+    /* load FSR0 with the top of RAM below the noinit section */
+    movlw low(NOINIT_BASE - 1)
+    movwf _FSR0L, 0
+    movlw high(NOINIT_BASE - 1)
     movwf _FSR0H, 0
 		
     /* place a 1 at address 0x00, as a marker 
@@ -108,6 +180,7 @@ clear_loop:
     movf 0x00, w
     bnz clear_loop
   __endasm ;
+#endif
 
   _do_cinit();
 
@@ -89,6 +89,10 @@ void    main(void)
 	 *  process_master_data() takes up a good chunk of 18.5ms.
 	 *  If it takes more than 18.5ms, data from the master processor
 	 *  will be lost.  ( May or may not be a big deal. )
+	 *
+	 *  If you install a frame callback with rc_set_frame_callback(),
+	 *  move this code into the callback.  This if condition is then
+	 *  never true, and the main loop must not call rc_read_data().
 	 */
 	
 	if ( rc_new_data_available() )
@@ -125,6 +129,38 @@ void    main(void)
 }
 
 
+/*
+ *  How this robot's ports are used, applied by custom_init().
+ *
+ *  Ports 1 through ANALOG_PORTS are analog, the rest digital inputs
+ *  unless listed in ROBOT_OUTPUTS.  Digital outputs can drive LEDs and
+ *  other low-current devices.  The shaft encoder counts can be read
+ *  back with shaft_encoder_read_std().
+ */
+#define ROBOT_OUTPUTS   IO_PORT_BIT(SONAR_OUTPUT_PORT)
+#define ROBOT_ENCODERS  (ROBOT_IPORT_BIT(LEFT_ENCODER_INTERRUPT_PORT) | \
+			 ROBOT_IPORT_BIT(RIGHT_ENCODER_INTERRUPT_PORT))
+
+/* Caught by the compiler rather than by a robot that won't move */
+ROBOT_CHECK_ANALOG(ANALOG_PORTS);
+ROBOT_CHECK_DIGITAL(SONAR_OUTPUT_PORT, ANALOG_PORTS);
+ROBOT_CHECK_DIGITAL(BUMPER_LEFT_PORT, ANALOG_PORTS);
+ROBOT_CHECK_DIGITAL(BUMPER_RIGHT_PORT, ANALOG_PORTS);
+ROBOT_CHECK_DIGITAL(COMPETITION_JUMPER_PORT, ANALOG_PORTS);
+ROBOT_CHECK_DIGITAL_MASK(ROBOT_OUTPUTS, ANALOG_PORTS);
+ROBOT_CHECK_DISJOINT(ROBOT_ENCODERS, ROBOT_IPORT_BIT(SONAR_INTERRUPT_PORT));
+
+static const ROM robot_config_t Robot =
+{
+    ANALOG_PORTS,
+    ROBOT_OUTPUTS, 0,
+    ROBOT_ENCODERS,
+    1, { { SONAR_INTERRUPT_PORT, SONAR_OUTPUT_PORT } },
+    ROBOT_TIMER_BIT(1),
+    0                   /* No reversed motors */
+};
+
+
 /****************************************************************************
  * Description: 
  *  This function initializes the controller according to the needs of
@@ -137,46 +173,18 @@ void    main(void)
 void    custom_init(void)
 
 {
-    int     c;
-
     /*
      *  Below are custom configurations for your robot.  This is where
      *  you set up digital output ports, analog ports, sensors, etc.
+     *  Add ports to the Robot table above and robot_configure() sets
+     *  them all up in one step.
      */
-     
-    /* Set some of the 16 I/O ports as inputs */
-    for (c = 1; c <= 16; ++c)
-	io_set_direction(c, IO_DIRECTION_IN);
+    if ( robot_configure(&Robot) != OV_OK )
+	ov_puts("robot_configure() failed.");
 
-    /*
-     *  Configure the number of analog input ports. Ports 1 through N
-     *  will be analog, and N+1 through 16 will be digital.
-     */
-    io_set_analog_port_count(ANALOG_PORTS);
-
-    /* Set some of the 16 I/O ports as outputs (digital output only). */
-    /* These can be used to drive LEDs and other low-current devices. */
-    //for (c = 9; c <= 16; ++c)
-    //    io_set_direction(c, IO_DIRECTION_OUT);
-
-    /* Initialize the values on the digital outputs. */
-    //for (c = 9; c <= 16; ++c)
-    //    io_set_digital(c,0);
-
-    /* Enable shaft encoder on any interrupt port */
-    /* The count can be read back with shaft_encoder_read_count() */
-    shaft_encoder_enable_std(LEFT_ENCODER_INTERRUPT_PORT);
-    shaft_encoder_enable_std(RIGHT_ENCODER_INTERRUPT_PORT);
-    
-    /* Example: Quad encoder requires two pots */
+    /* Example: Quad encoder requires two ports */
     // quad_encoder_enable(6, 8);
     
-    /* Enable sonar device and timer. */
-    if ( sonar_init(SONAR_INTERRUPT_PORT, SONAR_OUTPUT_PORT) != OV_OK )
-	printf("sonar_init() failed.\n");
-
-    timer_start(1);
-    
     controller_print_version();
 }
 
@@ -233,7 +241,7 @@ void    rc_routine(void)
     {
 	old_time = elapsed_time;
 #if DEBUG_STACK
-	stack_report();
+	debug_stack_report();
 #endif
 
 	line_sensor_read(LINE_SENSOR_LEFT_PORT, LINE_SENSOR_CENTER_PORT,
@@ -257,6 +265,10 @@ void    rc_routine(void)
 	    shaft_encoder_read_std(LEFT_ENCODER_INTERRUPT_PORT),
 	    shaft_encoder_read_std(RIGHT_ENCODER_INTERRUPT_PORT),
 	    SONAR_INTERRUPT_PORT, sonar_distance, timer_read_ms(1));
+#if DEBUG
+	/* Frames lost on the SPI link or missed by this loop */
+	link_stats_print();
+#endif
     }
 }
 
@@ -477,7 +489,7 @@ void    autonomous_routine0()
 	/* Drive forward for a while */
 	if ( shaft_tps_init(&shafts[0], 0, 180,
 	    LEFT_DRIVE_PORT, LEFT_ENCODER_INTERRUPT_PORT, 0, -60) != OV_OK )
-	    printf("shaft_tps_init() failed.\n");
+	    ov_puts("shaft_tps_init() failed.");
 	shaft_tps_init(&shafts[1], 0, 180,
 	    RIGHT_DRIVE_PORT, RIGHT_ENCODER_INTERRUPT_PORT, 0, 60);
 	shaft_tps_run(shafts, 2);
@@ -684,7 +696,7 @@ void    autonomous_routine3()
 void    autonomous_routine_competition(unsigned short seconds)
 
 {
-    printf("Running competition autonomous routine...\n");
+    ov_puts("Running competition autonomous routine...");
     controller_begin_autonomous_mode();
 
     /*
@@ -88,6 +88,10 @@ void    main(void)
 	 *  process_master_data() takes up a good chunk of 18.5ms.
 	 *  If it takes more than 18.5ms, data from the master processor
 	 *  will be lost.  ( May or may not be a big deal. )
+	 *
+	 *  If you install a frame callback with rc_set_frame_callback(),
+	 *  move this code into the callback.  This if condition is then
+	 *  never true, and the main loop must not call rc_read_data().
 	 */
 	
 	if ( rc_new_data_available() )
@@ -185,7 +189,7 @@ void    rc_routine(void)
     {
 	old_time = elapsed_time;
 #if DEBUG_STACK
-	stack_report();
+	debug_stack_report();
 #endif
 
 	/* 
@@ -307,7 +311,7 @@ void    autonomous_routine0(void)
 void    autonomous_routine_competition(unsigned short seconds)
 
 {
-    printf("Running competition autonomous routine...\n");
+    ov_puts("Running competition autonomous routine...");
     controller_begin_autonomous_mode();
 
     /*
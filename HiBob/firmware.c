@@ -32,7 +32,7 @@ void    main(void)
     while (TRUE)
     {
 	controller_submit_data(NO_WAIT);
-	printf("Hi, Bob!\n");
+	ov_puts("Hi, Bob!");
 	delay_sec(1);
     }
 }
@@ -110,10 +110,21 @@
 #include "accelerometer.h"
 #include "line_sensor.h"
 #include "arcade_drive.h"
+#include "link_stats.h"
+#include "latency.h"
+#include "input_event.h"
+#include "pwm_user.h"
+#include "pwm_output.h"
+#include "debounce.h"
+#include "robot_config.h"
+#include "adc_scan.h"
+#include "reset_diag.h"
+#include "mem_monitor.h"
+#include "ov_printf.h"
 
 /* Pointer to one of the double buffers controlled by the master SPI ISR */
 /* Essential global variables defined in the libraries */
-extern volatile rx_data_t       *User_rxdata;
+extern volatile rx_data_t       * volatile User_rxdata;
 extern tx_data_t                User_txdata;
 extern volatile tx_data_t       Tx_buff[2];
 extern volatile unsigned char   Tx_user_buff_index;
@@ -1,7 +1,8 @@
-#include <stdio.h>
 #include "timer.h"
 #include "io.h"
+#include "adc_scan.h"
 #include "accelerometer.h"
+#include "ov_printf.h"
 
 /**
  * \defgroup accelerometer  Accelerometer functions
@@ -62,6 +63,10 @@
  *  \param  acceleration Address of int variable to receive acceleration.
  *  \param  velocity    Address of int variable to receive velocity.
  *  \param  position    Address of int variable to receive position.
+ *
+ *  If the port is being sampled in the background with
+ *  adc_scan_enable(), e.g. with 2 extra bits, the background average
+ *  is used.  Otherwise each call averages SAMPLE_SIZE blocking reads.
  */
 
 /*
@@ -88,6 +93,7 @@ void    read_accelerometer_axis(unsigned char port, int base_val,
     static int              old_acceleration = 0,
 			    c;
     static unsigned int     calls = 0;
+    status_t                bits;
 
     /*
      *  Auto-scale dt to match frequency of calls to avoid integer overflows?
@@ -109,11 +115,21 @@ void    read_accelerometer_axis(unsigned char port, int base_val,
      *  dt should be much smaller to make an accelerometer useful for
      *  speed and distance computations.
      */
-    raw = 0;
-    for (c=0; c < SAMPLE_SIZE; ++c)
-	raw += (int)io_read_analog(port) - base_val;
-    raw /= SAMPLE_SIZE;
-    *acceleration = raw / 8;
+    bits = adc_scan_get_extra_bits(port);
+    if ( bits != OV_BAD_PARAM )
+    {
+	/* Already averaged in the background, see adc_scan_enable() */
+	raw = (long)adc_scan_read(port) - ((long)base_val << bits);
+	*acceleration = raw / (8 << bits);
+    }
+    else
+    {
+	raw = 0;
+	for (c=0; c < SAMPLE_SIZE; ++c)
+	    raw += (int)io_read_analog(port) - base_val;
+	raw /= SAMPLE_SIZE;
+	*acceleration = raw / 8;
+    }
 
     /* velocity is integral of acceleration */
     *velocity += (*acceleration + old_acceleration) * dt / 2 / scaling_factor;
@@ -124,7 +140,7 @@ void    read_accelerometer_axis(unsigned char port, int base_val,
     old_acceleration = *acceleration;
     old_velocity = *velocity;
     
-    printf("raw = %ld  accel = %d  velo = %ld  pos = %ld\n",
+    ov_printf("raw = %ld  accel = %d  velo = %ld  pos = %ld\n",
 	    raw, *acceleration, *velocity, *position);
 }
 
@@ -0,0 +1,583 @@
+/**************************************************************************
+*
+*   Background analog sampling with oversampling and decimation.
+*
+*   The 18F8520 ADC gives 10 bits, and sensors such as the accelerometer
+*   are noisy enough that the low bits are of little use from a single
+*   reading.  Ports registered with adc_scan_enable() are converted in
+*   the background, one conversion every 250us started by Timer2, with
+*   each result summed in the A/D interrupt.  Summing 4^n conversions
+*   and shifting the sum right by n gives n extra bits of resolution,
+*   provided there is at least an LSB or so of noise on the input,
+*   which is always the case on a robot.  Each port converts with the
+*   clock set by io_set_analog_timing(); the 250us between conversions
+*   is far longer than any acquisition time it needs.
+*
+*   The CPU cost is fixed by ADC_SCAN_RATE, not by the number of ports
+*   or extra bits: two short interrupts per conversion.  More ports or
+*   more extra bits only make each result take longer to arrive:
+*
+*       ms per result = ports * 4^extra_bits / 4
+*
+***************************************************************************
+*
+*   This code is free software: you can redistribute it and/or modify
+*   it under the terms of the GNU General Public License as published by
+*   the Free Software Foundation, either version 3 of the License, or
+*   (at your option) any later version.
+*
+*   This code is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License
+*   along with this code.  If not, see <http://www.gnu.org/licenses/>.
+*
+***************************************************************************/
+
+#include "platform.h"
+#include "io.h"
+#include "timer.h"
+#include "adc_scan.h"
+
+extern unsigned char    Timer_allocated[4];
+extern unsigned char    Analog_ports;
+extern unsigned char    Analog_clock[TOTAL_IO_PORTS];
+
+/* Shared with the low priority ISR */
+volatile unsigned short Adc_scan_mask = 0;      /* Bit (n-1) for port n */
+
+static volatile unsigned short  Adc_scan_ready;
+static volatile unsigned short  Adc_scan_result[TOTAL_IO_PORTS];
+static unsigned char            Adc_scan_bits[TOTAL_IO_PORTS];
+static unsigned char            Adc_scan_port;      /* 0 to 15 */
+static unsigned char            Adc_scan_count;
+static unsigned short           Adc_scan_sum;
+
+/* Threshold watches, checked by the ISR as each result is posted */
+static unsigned short           Adc_watch_mask;
+static unsigned short           Adc_watch_primed;   /* First result seen */
+static volatile unsigned short  Adc_watch_above;
+static volatile unsigned short  Adc_watch_rose;
+static volatile unsigned short  Adc_watch_fell;
+static unsigned short           Adc_watch_threshold[TOTAL_IO_PORTS];
+static unsigned short           Adc_watch_low[TOTAL_IO_PORTS];
+static unsigned char            Adc_watch_dir[TOTAL_IO_PORTS];
+
+static void adc_scan_next(void);
+
+/**
+ *  \addtogroup IO
+ *  @{
+ */
+
+/**
+ *  Start sampling an analog port in the background.
+ *
+ *  \param  port        Analog I/O port.
+ *  \param  extra_bits  Bits of resolution to add to the ADC's 10, from
+ *                      0 to ADC_SCAN_MAX_EXTRA_BITS.  Each result is
+ *                      the sum of 4^extra_bits conversions shifted
+ *                      right extra_bits places, so 2 gives 12 bit
+ *                      results from 16 conversions.
+ *
+ *  \returns    OV_OK on success, OV_BAD_PARAM if port is not analog
+ *              or extra_bits is too large, or if this is the first
+ *              port and Timer2 is already in use.
+ *
+ *  The first port enabled claims Timer2, so it is no longer available
+ *  to timer_allocate().  Calling this for a port already being sampled
+ *  changes its extra bits and discards its current result.
+ *
+ *  While any port is being sampled, io_read_analog() returns the
+ *  latest result for a sampled port, reduced to 10 bits, without
+ *  waiting for a conversion.  Other analog ports are still read
+ *  directly, briefly pausing the background sampling.
+ *
+ *  \code
+ *  adc_scan_enable(GYRO_PORT, 2);
+ *  ...
+ *  if ( adc_scan_ready(GYRO_PORT) )
+ *      heading += (long)adc_scan_read(GYRO_PORT) - GYRO_CENTER_12BIT;
+ *  \endcode
+ */
+
+/*
+ * History:
+ *  Oct 2026    J Bacon
+ */
+
+status_t    adc_scan_enable(unsigned char port, unsigned char extra_bits)
+
+{
+    unsigned short  bit;
+
+    if ( ! OV_USE_ADC_SCAN || ! VALID_ANALOG_PORT(port) ||
+	 (extra_bits > ADC_SCAN_MAX_EXTRA_BITS) )
+	return OV_BAD_PARAM;
+
+    if ( Adc_scan_mask == 0 )
+    {
+	if ( Timer_allocated[1] )
+	    return OV_BAD_PARAM;
+	Timer_allocated[1] = TIMER_LIBRARY;
+	Adc_scan_port = port - 1;
+    }
+    else
+	adc_scan_pause();
+
+    bit = IO_PORT_BIT(port);
+    Adc_scan_bits[port-1] = extra_bits;
+    Adc_scan_result[port-1] = 0;
+    Adc_scan_ready &= ~bit;
+    Adc_scan_mask |= bit;
+    if ( Adc_scan_port == port - 1 )
+	Adc_scan_sum = Adc_scan_count = 0;
+    adc_scan_resume();
+    return OV_OK;
+}
+
+
+/**
+ *  Stop sampling an analog port in the background.  Timer2 is freed
+ *  and the ADC turned off when the last port is removed.
+ *
+ *  \param  port    Analog I/O port.
+ */
+
+/*
+ * History:
+ *  Oct 2026    J Bacon
+ */
+
+void    adc_scan_disable(unsigned char port)
+
+{
+    unsigned short  bit;
+
+    if ( ! VALID_IO_PORT(port) )
+	return;
+    bit = IO_PORT_BIT(port);
+    if ( ! (Adc_scan_mask & bit) )
+	return;
+
+    adc_scan_pause();
+    Adc_scan_mask &= ~bit;
+    Adc_scan_ready &= ~bit;
+    Adc_watch_mask &= ~bit;
+    if ( Adc_scan_mask == 0 )
+    {
+	ADCON0 = 0;
+	timer_free(2);
+	return;
+    }
+    if ( Adc_scan_port == port - 1 )
+	adc_scan_next();
+    adc_scan_resume();
+}
+
+
+/**
+ *  Check for a new background sample.
+ *
+ *  \param  port    Analog port registered with adc_scan_enable().
+ *
+ *  \returns    1 if a result has arrived since the last
+ *              adc_scan_read() of this port, 0 otherwise or if the
+ *              port is not being sampled.
+ */
+
+/*
+ * History:
+ *  Oct 2026    J Bacon
+ */
+
+unsigned char   adc_scan_ready(unsigned char port)
+
+{
+    if ( ! VALID_IO_PORT(port) )
+	return 0;
+    return (Adc_scan_ready & Adc_scan_mask & IO_PORT_BIT(port)) != 0;
+}
+
+
+/**
+ *  Read the latest background sample at full resolution and clear
+ *  its ready flag.
+ *
+ *  \param  port    Analog port registered with adc_scan_enable().
+ *
+ *  \returns    0 to (0x400 << extra_bits) - 1, or OV_BAD_PARAM if the
+ *              port is not being sampled.  0 until the first result
+ *              arrives.
+ */
+
+/*
+ * History:
+ *  Oct 2026    J Bacon
+ */
+
+unsigned int    adc_scan_read(unsigned char port)
+
+{
+    unsigned int    result;
+    unsigned short  bit;
+    unsigned char   adie;
+
+    if ( ! VALID_IO_PORT(port) )
+	return OV_BAD_PARAM;
+    bit = IO_PORT_BIT(port);
+    if ( ! (Adc_scan_mask & bit) )
+	return OV_BAD_PARAM;
+
+    /*
+     *  The ISR writes 16-bit results, so keep it out while reading.
+     *  Restore ADIE rather than setting it, or reading while the scan
+     *  is paused by adc_scan_pause() would restart it.
+     */
+    adie = PIE1bits.ADIE;
+    PIE1bits.ADIE = 0;
+    result = Adc_scan_result[port-1];
+    Adc_scan_ready &= ~bit;
+    PIE1bits.ADIE = adie;
+    return result;
+}
+
+
+/**
+ *  Return the extra bits of resolution a port is being sampled with.
+ *
+ *  \param  port    Analog I/O port.
+ *
+ *  \returns    0 to ADC_SCAN_MAX_EXTRA_BITS, or OV_BAD_PARAM if the
+ *              port is not being sampled in the background.
+ */
+
+/*
+ * History:
+ *  Oct 2026    J Bacon
+ */
+
+status_t    adc_scan_get_extra_bits(unsigned char port)
+
+{
+    if ( ! VALID_IO_PORT(port) || ! (Adc_scan_mask & IO_PORT_BIT(port)) )
+	return OV_BAD_PARAM;
+    return Adc_scan_bits[port-1];
+}
+
+
+/**
+ *  Watch a background sampled port for threshold crossings.  Each
+ *  result is compared with the threshold in the A/D interrupt, so a
+ *  crossing is caught within one scan period with no polling.
+ *
+ *  \param  port        Analog I/O port.  If it is not already being
+ *                      sampled, adc_scan_enable(port, 0) is called.
+ *  \param  threshold   Level in the port's result units, i.e. 0 to
+ *                      (0x400 << extra_bits) - 1.
+ *  \param  hysteresis  How far below threshold the result must fall
+ *                      before it counts as below again.  Set this
+ *                      above the sensor noise to avoid a burst of
+ *                      crossings when the level hovers at threshold.
+ *  \param  directions  Crossings to report: ADC_WATCH_ROSE,
+ *                      ADC_WATCH_FELL, or both ORed together.
+ *
+ *  \returns    OV_OK on success, OV_BAD_PARAM if the port cannot be
+ *              sampled, hysteresis exceeds threshold or directions
+ *              is 0.
+ *
+ *  A port is above when its result reaches threshold, and below when
+ *  it drops under threshold - hysteresis.  The first result only sets
+ *  the starting state, so no crossing is reported for where the
+ *  sensor happens to be when watched.  Crossings are read with
+ *  adc_watch_crossed(), or turned into EVENT_ABOVE and EVENT_BELOW
+ *  events by event_watch_analog().
+ *
+ *  \code
+ *  adc_watch(LIGHT_SENSOR_PORT, LIGHT_THRESHOLD, 20, ADC_WATCH_ROSE);
+ *  ...
+ *  if ( adc_watch_crossed(LIGHT_SENSOR_PORT) & ADC_WATCH_ROSE )
+ *      respond_to_light();
+ *  \endcode
+ */
+
+/*
+ * History:
+ *  Oct 2026    J Bacon
+ */
+
+status_t    adc_watch(unsigned char port, unsigned short threshold,
+		      unsigned short hysteresis, unsigned char directions)
+
+{
+    unsigned short  bit;
+    unsigned char   adie;
+
+    if ( (hysteresis > threshold) ||
+	 ((directions & (ADC_WATCH_ROSE | ADC_WATCH_FELL)) == 0) )
+	return OV_BAD_PARAM;
+    if ( ! VALID_IO_PORT(port) )
+	return OV_BAD_PARAM;
+    bit = IO_PORT_BIT(port);
+    if ( ! (Adc_scan_mask & bit) && (adc_scan_enable(port, 0) != OV_OK) )
+	return OV_BAD_PARAM;
+
+    adie = PIE1bits.ADIE;
+    PIE1bits.ADIE = 0;
+    Adc_watch_threshold[port-1] = threshold;
+    Adc_watch_low[port-1] = threshold - hysteresis;
+    Adc_watch_dir[port-1] = directions;
+    Adc_watch_primed &= ~bit;
+    Adc_watch_rose &= ~bit;
+    Adc_watch_fell &= ~bit;
+    Adc_watch_mask |= bit;
+    PIE1bits.ADIE = adie;
+    return OV_OK;
+}
+
+
+/**
+ *  Stop watching a port for threshold crossings.  Background sampling
+ *  continues until adc_scan_disable().
+ *
+ *  \param  port    Analog I/O port.
+ */
+
+/*
+ * History:
+ *  Oct 2026    J Bacon
+ */
+
+void    adc_unwatch(unsigned char port)
+
+{
+    if ( VALID_IO_PORT(port) )
+	Adc_watch_mask &= ~IO_PORT_BIT(port);
+}
+
+
+/**
+ *  Report and clear the threshold crossings on a port since the last
+ *  call.
+ *
+ *  \param  port    Analog port registered with adc_watch().
+ *
+ *  \returns    ADC_WATCH_ROSE if the result has risen to threshold,
+ *              ADC_WATCH_FELL if it has fallen below threshold -
+ *              hysteresis, both if both have happened, or 0.
+ */
+
+/*
+ * History:
+ *  Oct 2026    J Bacon
+ */
+
+unsigned char   adc_watch_crossed(unsigned char port)
+
+{
+    unsigned char   crossed = 0,
+		    adie;
+    unsigned short  bit;
+
+    if ( ! VALID_IO_PORT(port) )
+	return 0;
+    bit = IO_PORT_BIT(port);
+    if ( ! (Adc_watch_mask & bit) )
+	return 0;
+
+    adie = PIE1bits.ADIE;
+    PIE1bits.ADIE = 0;
+    if ( Adc_watch_rose & bit )
+	crossed |= ADC_WATCH_ROSE;
+    if ( Adc_watch_fell & bit )
+	crossed |= ADC_WATCH_FELL;
+    Adc_watch_rose &= ~bit;
+    Adc_watch_fell &= ~bit;
+    PIE1bits.ADIE = adie;
+    return crossed;
+}
+
+
+/**
+ *  Report whether a watched port is currently above its threshold,
+ *  with hysteresis applied.
+ *
+ *  \param  port    Analog port registered with adc_watch().
+ *
+ *  \returns    1 if above, 0 if below or not yet sampled.
+ */
+
+/*
+ * History:
+ *  Oct 2026    J Bacon
+ */
+
+unsigned char   adc_watch_above(unsigned char port)
+
+{
+    if ( ! VALID_IO_PORT(port) )
+	return 0;
+    return (Adc_watch_above & Adc_watch_mask & IO_PORT_BIT(port)) != 0;
+}
+
+/** @} */
+
+
+/*
+ *  Read the latest background sample reduced to 10 bits, leaving
+ *  the ready flag alone.  Used by io_read_analog().
+ *
+ * History:
+ *  Oct 2026    J Bacon
+ */
+
+unsigned int    adc_scan_read10(unsigned char port)
+
+{
+    unsigned int    result;
+    unsigned char   adie;
+
+    adie = PIE1bits.ADIE;
+    PIE1bits.ADIE = 0;
+    result = Adc_scan_result[port-1];
+    PIE1bits.ADIE = adie;
+    return result >> Adc_scan_bits[port-1];
+}
+
+
+/*
+ *  Stop starting and collecting conversions so the ADC can be used
+ *  directly, as by io_read_analog().  A conversion in progress is
+ *  allowed to finish and discarded.  The partial sum is kept.
+ *
+ * History:
+ *  Oct 2026    J Bacon
+ */
+
+void    adc_scan_pause(void)
+
+{
+    TIMER2_DISABLE_INTERRUPTS();
+    PIE1bits.ADIE = 0;
+    while ( ADCON0bits.GO )
+	;
+    PIR1bits.ADIF = 0;
+}
+
+
+/*
+ *  Restore the ADC for the port being sampled and restart Timer2.
+ *  The full timer period passes before the next conversion, which
+ *  gives the input time to settle after any channel change.
+ *
+ * History:
+ *  Oct 2026    J Bacon
+ */
+
+void    adc_scan_resume(void)
+
+{
+    /* Same setup as adc_open8520(), but from Analog_ports for MCC18 too */
+    ADCON1 = (Analog_ports == TOTAL_IO_PORTS) ? 0x00 : 0x0F - Analog_ports;
+    ADCON2 = ADC_SCAN_ADCON2 | IO_ADC_ADCS(Analog_clock[Adc_scan_port]);
+    ADCON0 = (Adc_scan_port << 2) | ADC_SCAN_ADON;
+    PIR1bits.ADIF = 0;
+
+    TMR2 = 0;
+    PR2 = ADC_SCAN_PR2;
+    T2CON = ADC_SCAN_T2CON;
+    TIMER2_CLEAR_INTERRUPT_FLAG();
+    PIE1bits.ADIE = 1;
+    TIMER2_ENABLE_INTERRUPTS();
+}
+
+
+/*
+ *  Add a finished conversion to the sum for the current port, and
+ *  when enough have been summed, post the decimated result, check it
+ *  against any threshold watch and move on to the next port.  Called
+ *  by the low priority ISR on ADIF.
+ *
+ * History:
+ *  Oct 2026    J Bacon
+ */
+
+void    adc_scan_complete(void)
+
+{
+    unsigned char   bits,
+		    c;
+    unsigned short  bit,
+		    result;
+
+    Adc_scan_sum += ((unsigned short)ADRESH << 8) | ADRESL;
+    c = Adc_scan_port;
+    bits = Adc_scan_bits[c];
+    if ( ++Adc_scan_count < ADC_SCAN_SAMPLES(bits) )
+	return;
+
+    result = Adc_scan_sum >> bits;
+    bit = IO_PORT_BIT(c + 1);
+    Adc_scan_result[c] = result;
+    Adc_scan_ready |= bit;
+
+    if ( Adc_watch_mask & bit )
+    {
+	if ( ! (Adc_watch_primed & bit) )
+	{
+	    /* Starting state, not a crossing */
+	    Adc_watch_primed |= bit;
+	    if ( result >= Adc_watch_threshold[c] )
+		Adc_watch_above |= bit;
+	    else
+		Adc_watch_above &= ~bit;
+	}
+	else if ( Adc_watch_above & bit )
+	{
+	    if ( result < Adc_watch_low[c] )
+	    {
+		Adc_watch_above &= ~bit;
+		if ( Adc_watch_dir[c] & ADC_WATCH_FELL )
+		    Adc_watch_fell |= bit;
+	    }
+	}
+	else if ( result >= Adc_watch_threshold[c] )
+	{
+	    Adc_watch_above |= bit;
+	    if ( Adc_watch_dir[c] & ADC_WATCH_ROSE )
+		Adc_watch_rose |= bit;
+	}
+    }
+    adc_scan_next();
+}
+
+
+/*
+ *  Select the next port in Adc_scan_mask, which must not be 0, and
+ *  start a new sum.
+ *
+ * History:
+ *  Oct 2026    J Bacon
+ */
+
+static void adc_scan_next(void)
+
+{
+    unsigned char   c = Adc_scan_port;
+
+    do
+    {
+	if ( ++c == TOTAL_IO_PORTS )
+	    c = 0;
+    }   while ( ! (Adc_scan_mask & IO_PORT_BIT(c + 1)) );
+
+    Adc_scan_sum = Adc_scan_count = 0;
+    if ( c != Adc_scan_port )
+    {
+	Adc_scan_port = c;
+	ADCON0 = (c << 2) | ADC_SCAN_ADON;
+	ADCON2 = ADC_SCAN_ADCON2 | IO_ADC_ADCS(Analog_clock[c]);
+    }
+}
@@ -0,0 +1,74 @@
+/**************************************************************************
+* Description:
+*   Background analog sampling with oversampling and decimation.
+*
+***************************************************************************
+*
+*   This code is free software: you can redistribute it and/or modify
+*   it under the terms of the GNU General Public License as published by
+*   the Free Software Foundation, either version 3 of the License, or
+*   (at your option) any later version.
+*
+*   This code is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License
+*   along with this code.  If not, see <http://www.gnu.org/licenses/>.
+*
+***************************************************************************/
+
+#ifndef __adc_scan_h__
+#define __adc_scan_h__
+
+#ifndef __general_h__
+#include "general.h"
+#endif
+
+/*
+ *  Timer2 starts one conversion every 250us: prescale 16 and PR2 = 155
+ *  give 10MHz / 16 / 156 = 4006 Hz.  The time between the end of one
+ *  conversion and the next start is the acquisition time after a
+ *  channel change, so it must stay well above the 12us or so the
+ *  ADC needs.
+ */
+#define ADC_SCAN_T2CON          0x06    /* Postscale 1, on, prescale 16 */
+#define ADC_SCAN_PR2            155
+#define ADC_SCAN_RATE           4000    /* Conversions / second, approx */
+
+#define ADC_SCAN_ADCON2         0x80    /* Right justified, | ADCS bits */
+#define ADC_SCAN_ADON           0x01    /* ADCON0 bit 0 */
+
+/*
+ *  Extra bits of resolution.  Each extra bit costs 4 times as many
+ *  conversions: 4^bits are summed and the sum shifted right by bits.
+ */
+#define ADC_SCAN_MAX_EXTRA_BITS 2       /* 12 bit results */
+
+#define ADC_SCAN_SAMPLES(bits)  (1 << ((bits) << 1))
+
+/* adc_watch() directions and adc_watch_crossed() flags */
+#define ADC_WATCH_ROSE          0x01
+#define ADC_WATCH_FELL          0x02
+
+/* Shared with the low priority ISR */
+extern volatile unsigned short  Adc_scan_mask;
+
+/* adc_scan.c */
+status_t adc_scan_enable(unsigned char port, unsigned char extra_bits);
+void adc_scan_disable(unsigned char port);
+unsigned char adc_scan_ready(unsigned char port);
+unsigned int adc_scan_read(unsigned char port);
+status_t adc_scan_get_extra_bits(unsigned char port);
+status_t adc_watch(unsigned char port, unsigned short threshold,
+		   unsigned short hysteresis, unsigned char directions);
+void adc_unwatch(unsigned char port);
+unsigned char adc_watch_crossed(unsigned char port);
+unsigned char adc_watch_above(unsigned char port);
+unsigned int adc_scan_read10(unsigned char port);
+void adc_scan_pause(void);
+void adc_scan_resume(void);
+void adc_scan_complete(void);
+
+#endif
@@ -17,6 +17,10 @@
 
 COPY_VAR        udata   0x80
 
+; MPASM cannot read ram_layout.h.  CLEAR_MEM_NOINIT_BASE there stops
+; C builds if NOINIT_BASE changes without this.
+NOINIT_LOW      equ     0xc0            ; NOINIT_BASE = 0x7c0
+
 CLEAR_MEM       code
 
 	global  Clear_Memory
@@ -32,10 +36,19 @@ Clear_Loop
 	clrwdt
 	call    Clear_Bank
 	incf    FSR0H, f
-	movlw   0x8
+	movlw   0x7
 	subwf   FSR0H, w
 	btfss   STATUS, Z
 	goto    Clear_Loop
+
+; Bank 7 stops at the noinit section, whose contents survive a reset.
+; See the linker scripts and NOINIT_BASE in ram_layout.h.
+Clear_Last
+	clrf    POSTINC0
+	movlw   NOINIT_LOW
+	subwf   FSR0L, w
+	btfss   STATUS, Z
+	goto    Clear_Last
 	return
 
 Clear_Bank
@@ -0,0 +1,359 @@
+/**************************************************************************
+*
+*   Background debouncing and edge capture for digital inputs.
+*
+*   Bumpers, limit switches and jumpers bounce for a few milliseconds
+*   when they open or close, so reading them directly with
+*   io_read_digital() can see several changes for one press.  Once a
+*   port is registered with debounce_watch(), the low priority ISR
+*   samples all registered ports every millisecond with one
+*   io_read_digital_all() and runs an integrating debounce on each.
+*   The main loop reads the clean state, edge counts and the time of
+*   the last change whenever it likes, without waiting or sampling.
+*
+***************************************************************************
+*
+*   This code is free software: you can redistribute it and/or modify
+*   it under the terms of the GNU General Public License as published by
+*   the Free Software Foundation, either version 3 of the License, or
+*   (at your option) any later version.
+*
+*   This code is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License
+*   along with this code.  If not, see <http://www.gnu.org/licenses/>.
+*
+***************************************************************************/
+
+#include "platform.h"
+#include "io.h"
+#include "timer.h"
+#include "debounce.h"
+
+extern unsigned char    Timer_allocated[4];
+extern unsigned char    Analog_ports;
+
+/* Shared with the Timer4 branch of the low priority ISR */
+volatile unsigned short Debounce_mask = 0;      /* Bit (n-1) for port n */
+
+static volatile unsigned short  Debounce_state;
+static volatile unsigned short  Debounce_now;
+static unsigned char            Debounce_samples = DEBOUNCE_DEFAULT_SAMPLES;
+static unsigned char            Debounce_count[TOTAL_IO_PORTS];
+static volatile unsigned char   Debounce_rises[TOTAL_IO_PORTS];
+static volatile unsigned char   Debounce_falls[TOTAL_IO_PORTS];
+static volatile unsigned short  Debounce_changed_at[TOTAL_IO_PORTS];
+
+/**
+ *  \addtogroup IO
+ *  @{
+ */
+
+/**
+ *  Start debouncing a digital input in the background.
+ *
+ *  \param  port    Digital I/O port, configured as an input.
+ *
+ *  \returns    OV_OK on success, OV_BAD_PARAM if port is not a
+ *              digital input, or if this is the first port and
+ *              Timer4 is already in use.
+ *
+ *  The first port watched claims Timer4, so it is no longer available
+ *  to timer_allocate().  The debounced state starts out as the current
+ *  raw state.
+ *
+ *  \code
+ *  debounce_watch(BUMPER_PORT);
+ *  ...
+ *  if ( debounce_read(BUMPER_PORT) == DIGITAL_IN_CLOSED )
+ *      back_up();
+ *  \endcode
+ */
+
+/*
+ * History:
+ *  Oct 2026    J Bacon
+ */
+
+status_t    debounce_watch(unsigned char port)
+
+{
+    unsigned short  bit;
+
+    if ( ! OV_USE_DEBOUNCE || ! VALID_DIGITAL_INPUT_PORT(port) )
+	return OV_BAD_PARAM;
+
+    if ( Debounce_mask == 0 )
+    {
+	if ( Timer_allocated[3] )
+	    return OV_BAD_PARAM;
+	Timer_allocated[3] = TIMER_LIBRARY;
+	Debounce_now = 0;
+	TIMER4_DISABLE_INTERRUPTS();
+	TMR4 = 0;
+	PR4 = DEBOUNCE_PR4;
+	T4CON = DEBOUNCE_T4CON;
+	TIMER4_CLEAR_INTERRUPT_FLAG();
+    }
+
+    bit = IO_PORT_BIT(port);
+    TIMER4_DISABLE_INTERRUPTS();
+    if ( io_read_digital(port) )
+    {
+	Debounce_state |= bit;
+	Debounce_count[port-1] = Debounce_samples;
+    }
+    else
+    {
+	Debounce_state &= ~bit;
+	Debounce_count[port-1] = 0;
+    }
+    Debounce_rises[port-1] = Debounce_falls[port-1] = 0;
+    Debounce_changed_at[port-1] = Debounce_now;
+    Debounce_mask |= bit;
+    TIMER4_ENABLE_INTERRUPTS();
+    return OV_OK;
+}
+
+
+/**
+ *  Stop debouncing a digital input.  Timer4 is freed when the last
+ *  port is removed.
+ *
+ *  \param  port    Digital I/O port.
+ */
+
+/*
+ * History:
+ *  Oct 2026    J Bacon
+ */
+
+void    debounce_unwatch(unsigned char port)
+
+{
+    if ( ! VALID_IO_PORT(port) || ! (Debounce_mask & IO_PORT_BIT(port)) )
+	return;
+
+    TIMER4_DISABLE_INTERRUPTS();
+    Debounce_mask &= ~IO_PORT_BIT(port);
+    if ( Debounce_mask == 0 )
+	timer_free(4);
+    else
+	TIMER4_ENABLE_INTERRUPTS();
+}
+
+
+/**
+ *  Set how long an input must hold a new state before it is accepted.
+ *
+ *  \param  samples     Milliseconds, 1 to 255.  The default is
+ *                      DEBOUNCE_DEFAULT_SAMPLES.
+ *
+ *  \returns    OV_OK on success, OV_BAD_PARAM for 0.
+ *
+ *  An integrating debounce is used: each sample that agrees with the
+ *  last accepted state moves a counter one step back toward it, so
+ *  brief noise delays a change rather than restarting it.
+ */
+
+/*
+ * History:
+ *  Oct 2026    J Bacon
+ */
+
+status_t    debounce_set_samples(unsigned char samples)
+
+{
+    unsigned char   c;
+
+    if ( samples == 0 )
+	return OV_BAD_PARAM;
+
+    TIMER4_DISABLE_INTERRUPTS();
+    Debounce_samples = samples;
+    for (c = 0; c < TOTAL_IO_PORTS; ++c)
+	Debounce_count[c] = (Debounce_state & (1 << c)) ? samples : 0;
+    if ( Debounce_mask != 0 )
+	TIMER4_ENABLE_INTERRUPTS();
+    return OV_OK;
+}
+
+
+/**
+ *  Read the debounced state of a watched port.
+ *
+ *  \param  port    Digital I/O port registered with debounce_watch().
+ *
+ *  \returns    0 or 1, as for io_read_digital(), or OV_BAD_PARAM
+ *              if the port is not being watched.
+ */
+
+/*
+ * History:
+ *  Oct 2026    J Bacon
+ */
+
+unsigned char   debounce_read(unsigned char port)
+
+{
+    unsigned short  bit;
+
+    if ( ! VALID_IO_PORT(port) )
+	return OV_BAD_PARAM;
+    bit = IO_PORT_BIT(port);
+    if ( ! (Debounce_mask & bit) )
+	return OV_BAD_PARAM;
+    return (Debounce_state & bit) != 0;
+}
+
+
+/**
+ *  Read the debounced state of all watched ports at once.
+ *
+ *  \returns    Bit (n-1) is the state of port n, as for
+ *              io_read_digital_all().  Bits for ports not being
+ *              watched are 0.
+ */
+
+/*
+ * History:
+ *  Oct 2026    J Bacon
+ */
+
+unsigned short  debounce_read_all(void)
+
+{
+    unsigned short  state;
+
+    TIMER4_DISABLE_INTERRUPTS();
+    state = Debounce_state & Debounce_mask;
+    if ( Debounce_mask != 0 )
+	TIMER4_ENABLE_INTERRUPTS();
+    return state;
+}
+
+
+/**
+ *  Read the state, edge counts and time of last change for a port.
+ *
+ *  \param  port    Digital I/O port registered with debounce_watch().
+ *  \param  info    Address of structure to receive the data.
+ *
+ *  \returns    OV_OK on success, OV_BAD_PARAM if the port is not
+ *              being watched.
+ *
+ *  The counts wrap at 256, so compare them with earlier readings
+ *  rather than clearing them:
+ *
+ *  \code
+ *  debounce_read_port(LIMIT_PORT, &info);
+ *  if ( info.falls != last_falls )
+ *  {
+ *      last_falls = info.falls;
+ *      ++hits;
+ *  }
+ *  \endcode
+ */
+
+/*
+ * History:
+ *  Oct 2026    J Bacon
+ */
+
+status_t    debounce_read_port(unsigned char port, debounce_port_t *info)
+
+{
+    if ( ! VALID_IO_PORT(port) || ! (Debounce_mask & IO_PORT_BIT(port)) )
+	return OV_BAD_PARAM;
+
+    TIMER4_DISABLE_INTERRUPTS();
+    info->state = (Debounce_state & IO_PORT_BIT(port)) != 0;
+    info->rises = Debounce_rises[port-1];
+    info->falls = Debounce_falls[port-1];
+    info->changed_at = Debounce_changed_at[port-1];
+    TIMER4_ENABLE_INTERRUPTS();
+    return OV_OK;
+}
+
+
+/**
+ *  Read the debounce clock, which counts milliseconds since the first
+ *  port was watched and wraps every 65.5 seconds.  Subtract a
+ *  changed_at time from debounce_read_port() to find how long ago an
+ *  input changed.
+ */
+
+/*
+ * History:
+ *  Oct 2026    J Bacon
+ */
+
+unsigned short  debounce_time(void)
+
+{
+    unsigned short  now;
+
+    TIMER4_DISABLE_INTERRUPTS();
+    now = Debounce_now;
+    if ( Debounce_mask != 0 )
+	TIMER4_ENABLE_INTERRUPTS();
+    return now;
+}
+
+/** @} */
+
+
+/*
+ *  Sample and debounce all watched ports.  Called by the low priority
+ *  ISR every 1ms while Debounce_mask is not 0.
+ *
+ * History:
+ *  Oct 2026    J Bacon
+ */
+
+void    debounce_tick(void)
+
+{
+    unsigned short  sample,
+		    bit,
+		    pending;
+    unsigned char   c;
+
+    ++Debounce_now;
+    sample = io_read_digital_all();
+
+    /* Stop as soon as the last watched port is done */
+    for (c = 0, bit = 1, pending = Debounce_mask; pending != 0;
+	    ++c, bit <<= 1)
+    {
+	if ( ! (pending & bit) )
+	    continue;
+	pending &= ~bit;
+
+	if ( sample & bit )
+	{
+	    if ( Debounce_count[c] < Debounce_samples )
+	    {
+		if ( ++Debounce_count[c] == Debounce_samples &&
+		     ! (Debounce_state & bit) )
+		{
+		    Debounce_state |= bit;
+		    ++Debounce_rises[c];
+		    Debounce_changed_at[c] = Debounce_now;
+		}
+	    }
+	}
+	else if ( Debounce_count[c] > 0 )
+	{
+	    if ( --Debounce_count[c] == 0 && (Debounce_state & bit) )
+	    {
+		Debounce_state &= ~bit;
+		++Debounce_falls[c];
+		Debounce_changed_at[c] = Debounce_now;
+	    }
+	}
+    }
+}
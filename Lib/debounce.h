@@ -0,0 +1,60 @@
+/**************************************************************************
+* Description:
+*   Background debouncing and edge capture for digital inputs.
+*
+***************************************************************************
+*
+*   This code is free software: you can redistribute it and/or modify
+*   it under the terms of the GNU General Public License as published by
+*   the Free Software Foundation, either version 3 of the License, or
+*   (at your option) any later version.
+*
+*   This code is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License
+*   along with this code.  If not, see <http://www.gnu.org/licenses/>.
+*
+***************************************************************************/
+
+#ifndef __debounce_h__
+#define __debounce_h__
+
+#ifndef __general_h__
+#include "general.h"
+#endif
+
+/*
+ *  Timer4 ticks every 1ms: prescale 16, PR4 = 124 and postscale 5
+ *  give 10MHz / 16 / 125 / 5 = 1 kHz.
+ */
+#define DEBOUNCE_T4CON          0x26    /* Postscale 5, on, prescale 16 */
+#define DEBOUNCE_PR4            124
+
+/* Consecutive agreeing 1ms samples needed to accept a new state */
+#define DEBOUNCE_DEFAULT_SAMPLES    5
+
+typedef struct
+{
+    unsigned char   state;      /* Debounced state, 0 or 1 */
+    unsigned char   rises;      /* 0 to 1 changes, wraps at 256 */
+    unsigned char   falls;      /* 1 to 0 changes, wraps at 256 */
+    unsigned short  changed_at; /* debounce_time() of last change */
+}   debounce_port_t;
+
+/* Shared with the Timer4 branch of the low priority ISR */
+extern volatile unsigned short  Debounce_mask;
+
+/* debounce.c */
+status_t debounce_watch(unsigned char port);
+void debounce_unwatch(unsigned char port);
+status_t debounce_set_samples(unsigned char samples);
+unsigned char debounce_read(unsigned char port);
+unsigned short debounce_read_all(void);
+status_t debounce_read_port(unsigned char port, debounce_port_t *info);
+unsigned short debounce_time(void);
+void debounce_tick(void);
+
+#endif
@@ -1,6 +1,7 @@
-#include <stdio.h>
 #include "platform.h"
 #include "debug.h"
+#include "mem_monitor.h"
+#include "ov_printf.h"
 
 /**
  * \defgroup debug Debug
@@ -11,50 +12,34 @@
 
 /**
  *  Initialize all unused stack space to a known value.  Afterward, we can
- *  use debug_stack_report() to see how many markers were overwritten.  This
- *  function should be called early from main (but after controller_init())
- *  in order to paint as much of the stack as possible.  If called from
+ *  use debug_stack_report() to see how many markers were overwritten.
+ *  controller_init() already does this, so it is only needed to start
+ *  over, e.g. before measuring one part of a program.  If called from
  *  a function deeper in the call tree, more stack will be in use, and
  *  less will be painted with the sentinal value.
+ *
+ *  If we used a 1-byte value, there would be a 1/256 chance
+ *  that the value the program placed at the top of the stack is our
+ *  marker, leading to an erroneous report.  Hence, we use a 4-byte
+ *  marker, which has only a 1 in 4.2 billion chance.  A longword 
+ *  measurement is accurate enough for this purpose, and very reliable.
  */
 
 /*
  * History:
  *  Dec 2008    Ag Primatic, J Bacon
+ *  Oct 2026    J Bacon     Moved to mem_monitor.c
  */
 
 void    debug_stack_paint(void)
 
 {
-    unsigned long DATA   *stack = STACK_BASE;
-    int         ii;
-
-    /*
-     *  Report initial stack pointer location.  This may create a
-     *  high-water mark.
-     */
-    // printf("FSR1 = %x %x\n",FSR1H,FSR1L);
-    
-    /*
-     *  If we used a 1-byte value, there would be a 1/256 chance
-     *  that the value the program placed at the top of the stack is our
-     *  marker, leading to an erroneous report.  Hence, we use a 4-byte
-     *  marker, which has only a 1 in 4.2 billion chance.  A longword 
-     *  measurement is accurate enough for this purpose, and very reliable.
-     */
-#ifdef __SDCC
-    for (ii = 0; ii * sizeof(long) < FSR1L-4; ++ii)
-	stack[ii] = 0xdeadbeef;
-#else
-    for (ii = 63; ii * sizeof(long) > FSR1L+4; --ii)
-	stack[ii] = 0xdeadbeef;
-#endif
+    mem_monitor_init();
 }
 
 
 /**
- *  Report maximum stack usage so far (high water mark).  The stack must
- *  have been initialized with debug_stack_paint().  Note that printf()
+ *  Report maximum stack usage so far (high water mark).  Note that printf()
  *  is likely to create a high-water mark (it calls a chain of lower level
  *  functions down to the device-specific putc()), so if you want to know the
  *  true stack requirements of your code, avoid doing any other debug output
@@ -70,32 +55,14 @@ void    debug_stack_paint(void)
 /*
  * History:
  *  Dec 2008    Ag Primatic, J Bacon
+ *  Oct 2026    J Bacon     Moved to mem_monitor.c
  */
 
 void    debug_stack_report(void)
 
 {
-    long DATA *stack = STACK_BASE;
-    int     ii,
-	    size;
-
-#ifdef __SDCC
-    if (stack[0] != 0xdeadbeef) {
-	printf("Stack overflowed\r\n");
-	while (1)
-	    ;
-    }
-
-    for (ii = 1; stack[ii] == 0xdeadbeef; ii++)
-	;
-    size = 64 - ii;
-#else
-    for (ii = 63; stack[ii] == 0xdeadbeef; ii--)
-	;
-    size = ii;
-#endif
-    printf("FSR1 = %x %x Max stack usage so far = %d/64 longs.\n",
-	FSR1H, FSR1L, size, stack[ii]);
+    mem_monitor_check();
+    mem_monitor_print();
 }
 
 
@@ -107,8 +74,8 @@ void    debug_hex_dump(unsigned char *address, unsigned int count)
 
 {
     while ( count-- )
-	printf("%x ", *address++);
-    printf("\n");
+	ov_printf("%x ", *address++);
+    ov_putc('\n');
 }
 
 
@@ -5,8 +5,12 @@
 #define DEBUG_STACK     0
 #define DEBUG_SPI       0
 
+#ifndef __ov_printf_h__
+#include "ov_printf.h"
+#endif
+
 /**
- *  Each DPRINTF() is converted to printf() if the constant
+ *  Each DPRINTF() is converted to ov_printf() if the constant
  *  DEBUG is 1.  If DEBUG is 0, the entire DPRINTF() statement is removed
  *  by the preprocessor, cpp.
  *  Hence, by switching DEBUG from 1 to 0 and recompiling, you effectively
@@ -15,7 +19,7 @@
  */
 
 #if DEBUG
-#define DPRINTF(...)    printf(__VA_ARGS__)
+#define DPRINTF(...)    ov_printf(__VA_ARGS__)
 #else
 #define DPRINTF(...)
 #endif
@@ -27,7 +31,7 @@
 #endif
 
 /* debug.c */
-void debug_paint_stack_bank(void);
+void debug_stack_paint(void);
 void debug_stack_report(void);
 void debug_spi_buff_dump(unsigned char *);
 void debug_hex_dump(unsigned char *, unsigned int);
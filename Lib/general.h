@@ -43,6 +43,9 @@
 #define VALID_INTERRUPT_PORT(p) \
     ( ((p) >= 1) && ((p) <= TOTAL_INTERRUPT_PORTS) )
 
+#define VALID_IO_PORT(p) \
+    ( ((p) >= 1) && ((p) <= TOTAL_IO_PORTS) )
+
 #define VALID_ANALOG_PORT(p) \
     ( ((p) >= 1) && ((p) <= Analog_ports) )
 
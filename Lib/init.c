@@ -6,6 +6,8 @@
 #include "vex_spi.h"
 #include "master.h"
 #include "timer.h"
+#include "reset_diag.h"
+#include "mem_monitor.h"
 #include "init.h"
 
 /**
@@ -27,14 +29,16 @@ void    controller_init(void)
 {
     unsigned char c;
 
+    /* Must come first, before anything disturbs RCON and STKPTR */
+    reset_diag_init();
+
     init_regs();
 
     /* Enable serial output to a terminal via stdio functions. */
     usart_init();
 
-#if DEBUG_STACK
-    debug_paint_stack();
-#endif
+    /* As early as possible, so that as much stack as possible is painted */
+    mem_monitor_init();
 
     /* Make sure all motors are off when the program starts. */
     for (c=1; c<=8; ++c)
@@ -52,6 +56,12 @@ void    controller_init(void)
     for (c=1; c<=4; ++c)
 	timer_stop(c);
 
+    /*
+     *  Start the system timer now rather than after the first packet
+     *  from the master, so it covers the whole of startup.
+     */
+    timer0_init();
+
     User_txdata.packet_num = 0;
     User_txdata.current_mode = 1;
     User_txdata.control = 0xc9;     /* ?? From defaut code packet dump */
@@ -83,9 +93,6 @@ void    controller_init(void)
 
     while ( ! rc_new_data_available() )
 	; 
-    
-    // Start system timer
-    timer0_init();
 }
 
 
@@ -0,0 +1,456 @@
+/**************************************************************************
+*
+*   Input event engine.  Turns RC buttons, digital inputs and analog
+*   thresholds into a queue of debounced press, release, long-press,
+*   sequence and threshold events, so that user code doesn't have to
+*   keep its own edge detection state for every input.
+*
+***************************************************************************
+*
+*   This code is free software: you can redistribute it and/or modify
+*   it under the terms of the GNU General Public License as published by
+*   the Free Software Foundation, either version 3 of the License, or
+*   (at your option) any later version.
+*
+*   This code is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License
+*   along with this code.  If not, see <http://www.gnu.org/licenses/>.
+*
+***************************************************************************/
+
+#include "platform.h"
+#include "io.h"
+#include "master.h"
+#include "adc_scan.h"
+#include "input_event.h"
+
+extern unsigned char    Analog_ports;
+
+/* Watched inputs, bit (n-1) for channel or port n */
+static unsigned char    Event_rc_mask = 0;
+static unsigned short   Event_digital_mask = 0;
+static unsigned short   Event_analog_mask = 0;
+
+static event_state_t    Event_rc_state[TOTAL_RC_CHANNELS];
+static event_state_t    Event_digital_state[TOTAL_IO_PORTS];
+
+/* Button sequences, RC channels only */
+static unsigned char    Event_seq_len[TOTAL_RC_CHANNELS];
+static unsigned char    Event_seq_count[TOTAL_RC_CHANNELS];
+static unsigned char    Event_seq_val[TOTAL_RC_CHANNELS];
+
+static unsigned char    Event_debounce_frames = EVENT_DEFAULT_DEBOUNCE_FRAMES;
+static unsigned char    Event_long_press_frames = EVENT_DEFAULT_LONG_PRESS_FRAMES;
+
+/*
+ *  Events are added only by event_update() and removed only by
+ *  event_get(), each of which writes only its own index.  Hence,
+ *  event_update() can safely run in a frame callback while the
+ *  main loop drains the queue.
+ */
+static event_t                  Event_queue[EVENT_QUEUE_SIZE];
+static volatile unsigned char   Event_head = 0,
+				Event_tail = 0;
+static unsigned char            Event_overflow_count = 0;
+
+static void event_track(unsigned char source, event_state_t *st, unsigned char sample);
+static void event_post(unsigned char source, unsigned char type, unsigned char value);
+
+/**
+ *  \defgroup input_event Input Events
+ *  @{
+ *
+ *  These functions watch RC button channels and digital inputs once
+ *  per frame, and queue an event whenever one is pressed, released,
+ *  held for a long time, or used to enter a button sequence, and
+ *  whenever a watched analog input crosses its threshold.
+ *  Any number of channels can be watched at once, unlike
+ *  rc_button_sequence(), which tracks a single channel.
+ *
+ *  \code
+ *  event_t ev;
+ *
+ *  event_watch_rc(5, 2);
+ *  event_watch_digital(BUMPER_LEFT_PORT);
+ *  ...
+ *  if ( rc_new_data_available() )
+ *  {
+ *      event_update();
+ *      while ( event_get(&ev) )
+ *      {
+ *          if ( (ev.source == EVENT_SOURCE_DIGITAL(BUMPER_LEFT_PORT))
+ *                && (ev.type == EVENT_PRESS) )
+ *              back_up();
+ *          else if ( ev.type == EVENT_SEQUENCE )
+ *              run_autonomous_routine(ev.value);
+ *      }
+ *  }
+ *  \endcode
+ */
+
+/**
+ *  Generate events for the buttons on an RC channel.
+ *
+ *  \param  channel         RC channel, 1 to 6.
+ *  \param  sequence_len    If non-zero, also generate an EVENT_SEQUENCE
+ *                          after every sequence_len presses, whose value
+ *                          is the binary sequence entered (lower = 0,
+ *                          upper = 1), as with rc_button_sequence().
+ *
+ *  \returns    OV_OK on success, OV_BAD_PARAM for an invalid channel
+ *              or a sequence longer than 8.
+ */
+
+/*
+ * History:
+ *  Oct 2026    J Bacon
+ */
+
+status_t    event_watch_rc(unsigned char channel, unsigned char sequence_len)
+
+{
+    if ( ! VALID_RC_CHANNEL(channel) || (sequence_len > 8) )
+	return OV_BAD_PARAM;
+
+    Event_seq_len[channel-1] = sequence_len;
+    Event_seq_count[channel-1] = Event_seq_val[channel-1] = 0;
+    Event_rc_state[channel-1].stable = 0;
+    Event_rc_state[channel-1].count = 0;
+    Event_rc_mask |= 1 << (channel-1);
+    return OV_OK;
+}
+
+
+/**
+ *  Generate events for a digital input.  A press is a closed contact
+ *  (DIGITAL_IN_CLOSED), such as a bumper switch being hit.
+ *
+ *  \param  port    Digital I/O port, configured as an input.
+ *
+ *  \returns    OV_OK on success, OV_BAD_PARAM if port is not a
+ *              digital input.
+ */
+
+/*
+ * History:
+ *  Oct 2026    J Bacon
+ */
+
+status_t    event_watch_digital(unsigned char port)
+
+{
+    if ( ! VALID_DIGITAL_INPUT_PORT(port) )
+	return OV_BAD_PARAM;
+
+    Event_digital_state[port-1].stable = 0;
+    Event_digital_state[port-1].count = 0;
+    Event_digital_mask |= IO_PORT_BIT(port);
+    return OV_OK;
+}
+
+
+/**
+ *  Stop generating events for a digital input.
+ *
+ *  \param  port    Digital I/O port.
+ *
+ *  \returns    OV_OK on success, OV_BAD_PARAM if port is invalid.
+ */
+
+/*
+ * History:
+ *  Oct 2026    J Bacon
+ */
+
+status_t    event_unwatch_digital(unsigned char port)
+
+{
+    if ( ! VALID_IO_PORT(port) )
+	return OV_BAD_PARAM;
+
+    Event_digital_mask &= ~IO_PORT_BIT(port);
+    return OV_OK;
+}
+
+
+/**
+ *  Generate EVENT_ABOVE and EVENT_BELOW events when an analog input
+ *  crosses a threshold.  The crossing itself is detected in the
+ *  background by adc_watch(), so a brief crossing between frames is
+ *  not missed, and no conversion is done by event_update().
+ *
+ *  \param  port        Analog I/O port.
+ *  \param  threshold   See adc_watch().
+ *  \param  hysteresis  See adc_watch().
+ *  \param  directions  ADC_WATCH_ROSE for EVENT_ABOVE, ADC_WATCH_FELL
+ *                      for EVENT_BELOW, or both.
+ *
+ *  \returns    OV_OK on success, or OV_BAD_PARAM from adc_watch().
+ *
+ *  \code
+ *  event_watch_analog(LIGHT_SENSOR_PORT, LIGHT_THRESHOLD, 20,
+ *                     ADC_WATCH_ROSE);
+ *  ...
+ *  if ( (ev.source == EVENT_SOURCE_ANALOG(LIGHT_SENSOR_PORT))
+ *        && (ev.type == EVENT_ABOVE) )
+ *      respond_to_light();
+ *  \endcode
+ */
+
+/*
+ * History:
+ *  Oct 2026    J Bacon
+ */
+
+status_t    event_watch_analog(unsigned char port, unsigned short threshold,
+			       unsigned short hysteresis,
+			       unsigned char directions)
+
+{
+    if ( adc_watch(port, threshold, hysteresis, directions) != OV_OK )
+	return OV_BAD_PARAM;
+
+    Event_analog_mask |= IO_PORT_BIT(port);
+    return OV_OK;
+}
+
+
+/**
+ *  Stop generating events for an analog input, and stop watching its
+ *  threshold.
+ *
+ *  \param  port    Analog I/O port.
+ *
+ *  \returns    OV_OK on success, OV_BAD_PARAM if port is invalid.
+ */
+
+/*
+ * History:
+ *  Oct 2026    J Bacon
+ */
+
+status_t    event_unwatch_analog(unsigned char port)
+
+{
+    if ( ! VALID_IO_PORT(port) )
+	return OV_BAD_PARAM;
+
+    Event_analog_mask &= ~IO_PORT_BIT(port);
+    adc_unwatch(port);
+    return OV_OK;
+}
+
+
+/**
+ *  Set event timing, in frames (18.5ms each).
+ *
+ *  \param  debounce_frames     Frames an input must hold a new state
+ *                              before it is accepted.  1 disables
+ *                              debouncing.
+ *  \param  long_press_frames   Frames a button must be held to generate
+ *                              an EVENT_LONG_PRESS, 0 for never.
+ */
+
+/*
+ * History:
+ *  Oct 2026    J Bacon
+ */
+
+void    event_set_timing(unsigned char debounce_frames,
+			unsigned char long_press_frames)
+
+{
+    Event_debounce_frames = debounce_frames ? debounce_frames : 1;
+    Event_long_press_frames = long_press_frames;
+}
+
+
+/**
+ *  Sample all watched inputs and queue any resulting events.  Call
+ *  this once each time rc_new_data_available() returns TRUE, or
+ *  from a frame callback.  See rc_set_frame_callback().
+ */
+
+/*
+ * History:
+ *  Oct 2026    J Bacon
+ */
+
+void    event_update(void)
+
+{
+    unsigned char   c,
+		    sample;
+    signed char     val;
+    unsigned short  mask;
+
+    for (c = 1; c <= TOTAL_RC_CHANNELS; ++c)
+    {
+	if ( Event_rc_mask & (1 << (c-1)) )
+	{
+	    val = RC_READ_DATA(c);
+	    if ( val < BUTTON_REV_THRESH )
+		sample = 1;
+	    else if ( val > BUTTON_FWD_THRESH )
+		sample = 2;
+	    else
+		sample = 0;
+	    event_track(EVENT_SOURCE_RC(c), &Event_rc_state[c-1], sample);
+	}
+    }
+
+    for (c = 1, mask = 1; c <= TOTAL_IO_PORTS; ++c, mask <<= 1)
+    {
+	if ( Event_digital_mask & mask )
+	{
+	    sample = (io_read_digital(c) == DIGITAL_IN_CLOSED);
+	    event_track(EVENT_SOURCE_DIGITAL(c), &Event_digital_state[c-1],
+			sample);
+	}
+    }
+
+    /* Already debounced by hysteresis in the A/D interrupt */
+    for (c = 1, mask = 1; c <= TOTAL_IO_PORTS; ++c, mask <<= 1)
+    {
+	if ( Event_analog_mask & mask )
+	{
+	    sample = adc_watch_crossed(c);
+	    if ( sample & ADC_WATCH_ROSE )
+		event_post(EVENT_SOURCE_ANALOG(c), EVENT_ABOVE, 0);
+	    if ( sample & ADC_WATCH_FELL )
+		event_post(EVENT_SOURCE_ANALOG(c), EVENT_BELOW, 0);
+	}
+    }
+}
+
+
+/**
+ *  Remove the oldest event from the queue.
+ *
+ *  \param  event   Address of structure to receive the event.
+ *
+ *  \returns    TRUE if an event was returned, FALSE if the queue
+ *              is empty.
+ */
+
+/*
+ * History:
+ *  Oct 2026    J Bacon
+ */
+
+unsigned char   event_get(event_t *event)
+
+{
+    unsigned char   tail = Event_tail;
+
+    if ( tail == Event_head )
+	return FALSE;
+    *event = Event_queue[tail];
+    Event_tail = (tail + 1) & (EVENT_QUEUE_SIZE - 1);
+    return TRUE;
+}
+
+
+/**
+ *  Report how many events have been dropped because the queue was
+ *  full.  If this is not 0, drain the queue more often.
+ */
+
+/*
+ * History:
+ *  Oct 2026    J Bacon
+ */
+
+unsigned char   event_overflows(void)
+
+{
+    return Event_overflow_count;
+}
+
+
+/*
+ *  Debounce one input and generate its events.  sample is 0 when
+ *  released, 1 for the lower RC button or a closed contact, and 2
+ *  for the upper RC button.
+ *
+ * History:
+ *  Oct 2026    J Bacon
+ */
+
+static void event_track(unsigned char source, event_state_t *st,
+			unsigned char sample)
+
+{
+    unsigned char   c;
+
+    if ( sample == st->stable )
+    {
+	st->count = 0;
+	if ( (st->stable != 0) && (st->held != 255) )
+	{
+	    if ( ++st->held == Event_long_press_frames )
+		event_post(source, EVENT_LONG_PRESS, st->stable - 1);
+	}
+	return;
+    }
+
+    if ( ++st->count < Event_debounce_frames )
+	return;
+
+    /* New state accepted.  Going straight from lower to upper is both. */
+    if ( st->stable != 0 )
+	event_post(source, EVENT_RELEASE, st->stable - 1);
+    st->stable = sample;
+    st->count = 0;
+    st->held = 0;
+    if ( sample == 0 )
+	return;
+
+    event_post(source, EVENT_PRESS, sample - 1);
+
+    if ( EVENT_IS_RC(source) )
+    {
+	c = source - 1;
+	if ( Event_seq_len[c] != 0 )
+	{
+	    /* Insert new digit in LSB */
+	    Event_seq_val[c] = (Event_seq_val[c] << 1) + (sample - 1);
+	    if ( ++Event_seq_count[c] == Event_seq_len[c] )
+	    {
+		event_post(source, EVENT_SEQUENCE, Event_seq_val[c]);
+		Event_seq_count[c] = Event_seq_val[c] = 0;
+	    }
+	}
+    }
+}
+
+
+/*
+ * History:
+ *  Oct 2026    J Bacon
+ */
+
+static void event_post(unsigned char source, unsigned char type,
+		       unsigned char value)
+
+{
+    unsigned char   head = Event_head,
+		    next = (head + 1) & (EVENT_QUEUE_SIZE - 1);
+
+    if ( next == Event_tail )
+    {
+	if ( Event_overflow_count != 255 )
+	    ++Event_overflow_count;
+	return;
+    }
+    Event_queue[head].source = source;
+    Event_queue[head].type = type;
+    Event_queue[head].value = value;
+    Event_head = next;
+}
+
+/** @} */
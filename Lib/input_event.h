@@ -0,0 +1,83 @@
+/**************************************************************************
+* Description:
+*   Press/release/long-press/sequence events for RC buttons and
+*   digital inputs.
+*
+***************************************************************************
+*
+*   This code is free software: you can redistribute it and/or modify
+*   it under the terms of the GNU General Public License as published by
+*   the Free Software Foundation, either version 3 of the License, or
+*   (at your option) any later version.
+*
+*   This code is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License
+*   along with this code.  If not, see <http://www.gnu.org/licenses/>.
+*
+***************************************************************************/
+
+#ifndef __input_event_h__
+#define __input_event_h__
+
+#ifndef __general_h__
+#include "general.h"
+#endif
+
+/* Event sources: RC channels 1-6, digital and analog I/O ports 1-16 */
+#define EVENT_SOURCE_RC(channel)    (channel)
+#define EVENT_SOURCE_DIGITAL(port)  (16 + (port))
+#define EVENT_SOURCE_ANALOG(port)   (32 + (port))
+#define EVENT_IS_RC(source)         ((source) <= 16)
+#define EVENT_IS_ANALOG(source)     ((source) > 32)
+#define EVENT_PORT(source)          ((((source) - 1) & 0x0f) + 1)
+
+/* Event types */
+#define EVENT_PRESS         1
+#define EVENT_RELEASE       2
+#define EVENT_LONG_PRESS    3
+#define EVENT_SEQUENCE      4
+#define EVENT_ABOVE         5   /* Analog input rose to threshold */
+#define EVENT_BELOW         6   /* Analog input fell below threshold */
+
+/* Value of RC press/release events, also the digit used in sequences */
+#define EVENT_BUTTON_LOWER  0
+#define EVENT_BUTTON_UPPER  1
+
+/* Must be a power of 2 */
+#define EVENT_QUEUE_SIZE    8
+
+#define EVENT_DEFAULT_DEBOUNCE_FRAMES   2
+#define EVENT_DEFAULT_LONG_PRESS_FRAMES 54  /* About 1 second */
+
+typedef struct
+{
+    unsigned char   source;     /* EVENT_SOURCE_*() */
+    unsigned char   type;       /* EVENT_PRESS, ... */
+    unsigned char   value;      /* Button or sequence value */
+}   event_t;
+
+/* Per-source debounce state, kept by input_event.c */
+typedef struct
+{
+    unsigned char   stable;     /* 0 = released, 1 = lower/closed, 2 = upper */
+    unsigned char   count;      /* Frames the input has differed from stable */
+    unsigned char   held;       /* Frames stable has been held */
+}   event_state_t;
+
+/* input_event.c */
+status_t event_watch_rc(unsigned char channel, unsigned char sequence_len);
+status_t event_watch_digital(unsigned char port);
+status_t event_unwatch_digital(unsigned char port);
+status_t event_watch_analog(unsigned char port, unsigned short threshold,
+			    unsigned short hysteresis, unsigned char directions);
+status_t event_unwatch_analog(unsigned char port);
+void event_set_timing(unsigned char debounce_frames, unsigned char long_press_frames);
+void event_update(void);
+unsigned char event_get(event_t *event);
+unsigned char event_overflows(void);
+
+#endif
@@ -34,19 +34,48 @@
 #include "sonar.h"
 #include "interrupts.h"
 #include "io.h"
+#include "pwm_user.h"
+#include "debounce.h"
+#include "adc_scan.h"
+#include "mem_monitor.h"
+
+/*
+ *  Globals used on nearly every pass through the ISR live in the
+ *  access bank, so the ISR needs no MOVLB to reach them.  The ISR_HOT
+ *  section is small.  See platform.h before adding to it.  No
+ *  initializers here: the startup code clears them.
+ */
+#ifdef __SDCC
+#pragma udata access ISR_HOT Timer0_overflows Sonar_on_iport
+#pragma udata access ISR_HOT Encoder_ticks Encoder_on_iport
+#pragma udata access ISR_HOT Porta_sample Portf_sample Porth_sample
+#else
+#pragma udata access ISR_HOT
+#endif
+NEAR volatile unsigned int  Timer0_overflows;  /* Extends Timer0 */
+NEAR unsigned char          Sonar_on_iport[6];
+NEAR volatile unsigned int  Encoder_ticks[6];
+NEAR unsigned char          Encoder_on_iport[6];
+
+/* Samples of digital inputs taken by ISR for good timing */
+NEAR volatile unsigned char Porta_sample, Portf_sample, Porth_sample;
+#ifndef __SDCC
+#pragma udata
+#endif
 
-/* Timer interrupt (overflow) counts.  Extend each timer to 32 bits */
-unsigned int    Timer0_overflows;
-unsigned int    Timer1_overflows;
-unsigned long   Timer2_overflows;
-unsigned int    Timer3_overflows;
-unsigned long   Timer4_overflows;
+/*
+ *  Timer interrupt (overflow) counts.  Extend each timer to 32 bits.
+ *  Volatile, since timer*_read32() read them twice on purpose.
+ */
+volatile unsigned int   Timer1_overflows;
+volatile unsigned long  Timer2_overflows;
+volatile unsigned int   Timer3_overflows;
+volatile unsigned long  Timer4_overflows;
 
 /* Access via macros defined in interrupts.h */
 unsigned char   Interrupt_port_in_use[6] = {0,0,0,0,0,0};
 
 /* Sonar globals */
-unsigned char           Sonar_on_iport[6] = {0,0,0,0,0,0};
 unsigned char           Sonar_output_port[6];
 volatile unsigned char  Sonar_data_available[6] = {0,0,0,0,0,0};
 volatile unsigned short Sonar_echo_time[6] = {0,0,0,0,0,0};
@@ -55,13 +84,12 @@ volatile unsigned short Timer0_at_echo[6];
 extern unsigned char    Analog_ports;
 
 /* Shaft encoder globals */
-volatile unsigned int   Encoder_ticks[6] = {0,0,0,0,0,0};
-unsigned char           Encoder_on_iport[6] = {0,0,0,0,0,0};
 unsigned char           Quad_input_port[6] = {0,0,0,0,0,0};
 extern unsigned char    Analog_ports;
 
-/* Samples of digital inputs taken by ISR for good timing */
-volatile unsigned char  Porta_sample, Portf_sample, Porth_sample;
+/* Called at low priority after each SPI packet.  See rc_set_frame_callback() */
+void                    (* volatile Frame_callback)(void);
+volatile unsigned char  In_frame_callback = 0;
 
 
 /****************************************************************************
@@ -209,9 +237,11 @@ void InterruptVectorLow(void) NAKED_INTERRUPT_VECTOR(2)
 
 void    InterruptHandlerLow(void) INTERRUPT
 {
+#if OV_USE_INTERRUPT_PORTS
     int                     mask,
 			    p;
     unsigned char           new_portb;
+#endif
     
     /*
      *  Since the Vex interrupt ports 3 - 6 all use the RB interrupt,
@@ -258,7 +288,9 @@ void    InterruptHandlerLow(void) INTERRUPT
      *  interrupts are enabled.  Hence, we just initialize old_portb[]
      *  to 0s.
      */
+#if OV_USE_INTERRUPT_PORTS
     volatile static unsigned char    old_portb = 0;
+#endif
     
     /*
      *  INTERRUPT_IN[3-6] (RB4, RB5, RB6, or RB7) all use INTRB.
@@ -276,10 +308,20 @@ void    InterruptHandlerLow(void) INTERRUPT
      *  to sample them all than to figure out which ones need to be
      *  sampled, if any.
      */
+#if OV_USE_ENCODER_QUAD
     Porta_sample = PORTA;
     Portf_sample = PORTF;
     Porth_sample = PORTH;
+#endif
+
+    /* How deep the interrupted code was.  See mem_monitor.c. */
+    MEM_MONITOR_ISR();
 
+    /*
+     *  Each subsystem left out in openvex_config.h is left out here
+     *  too.  A port is used by at most one of them.
+     */
+#if OV_USE_INTERRUPT_PORTS
     if (INTCONbits.RBIF)
     {
 	/*
@@ -313,12 +355,18 @@ void    InterruptHandlerLow(void) INTERRUPT
 		/* Rising edge on PORTB bit "port"? */
 		if ( new_portb & mask ) /* Rising edge */
 		{
+#if OV_USE_ENCODER_STD
 		    if ( ENCODER_ON_IPORT(p) == ENCODER_STD )
 			SHAFT_ENCODER_ISR(p);
-		    else if ( ENCODER_ON_IPORT(p) == ENCODER_QUAD )
+#endif
+#if OV_USE_ENCODER_QUAD
+		    if ( ENCODER_ON_IPORT(p) == ENCODER_QUAD )
 			quad_encoder_isr(p);
-		    else if ( SONAR_ON_IPORT(p) )
+#endif
+#if OV_USE_SONAR
+		    if ( SONAR_ON_IPORT(p) )
 			sonar_emit_isr(p);
+#endif
 		    old_portb |= mask;      /* Update "old" bit state */
 		}
 		/* Falling edge on PORTB bit "port"? */
@@ -329,8 +377,10 @@ void    InterruptHandlerLow(void) INTERRUPT
 		     *  counting twice as many pulses as on interrupts
 		     *  1 & 2, which only trigger on one edge.
 		     */
+#if OV_USE_SONAR
 		    if ( SONAR_ON_IPORT(p) )
 			sonar_echo_isr(p);
+#endif
 		    old_portb &= ~mask;     /* Update "old" bit state */
 		}
 	    }
@@ -344,17 +394,23 @@ void    InterruptHandlerLow(void) INTERRUPT
     if (INTCON3bits.INT2IF)
     {
 	INTCON3bits.INT2IF = 0;
+#if OV_USE_ENCODER_STD
 	if ( ENCODER_ON_IPORT(1) == ENCODER_STD )
 	    SHAFT_ENCODER_ISR(1);
-	else if ( ENCODER_ON_IPORT(1) == ENCODER_QUAD )
+#endif
+#if OV_USE_ENCODER_QUAD
+	if ( ENCODER_ON_IPORT(1) == ENCODER_QUAD )
 	    quad_encoder_isr(1);
-	else if ( SONAR_ON_IPORT(1) )
+#endif
+#if OV_USE_SONAR
+	if ( SONAR_ON_IPORT(1) )
 	{
 	    if (INTCON2bits.INTEDG2)    /* Rising edge? */
 		sonar_emit_isr(1);
 	    else
 		sonar_echo_isr(1);
 	}
+#endif
     }
     
     /*
@@ -364,18 +420,25 @@ void    InterruptHandlerLow(void) INTERRUPT
     if (INTCON3bits.INT3IF)
     {
 	INTCON3bits.INT3IF = 0;
+#if OV_USE_ENCODER_STD
 	if ( ENCODER_ON_IPORT(2) == ENCODER_STD )
 	    SHAFT_ENCODER_ISR(2);
-	else if ( ENCODER_ON_IPORT(2) == ENCODER_QUAD )
+#endif
+#if OV_USE_ENCODER_QUAD
+	if ( ENCODER_ON_IPORT(2) == ENCODER_QUAD )
 	    quad_encoder_isr(2);
-	else if ( SONAR_ON_IPORT(2) )
+#endif
+#if OV_USE_SONAR
+	if ( SONAR_ON_IPORT(2) )
 	{
 	    if (INTCON2bits.INTEDG3)    /* Rising edge? */
 		sonar_emit_isr(2);
 	    else
 		sonar_echo_isr(2);
 	}
+#endif
     }
+#endif
     
     /* Timer 0 overflow interrupt */
     if ( INTCONbits.T0IF )
@@ -384,46 +447,108 @@ void    InterruptHandlerLow(void) INTERRUPT
 	++Timer0_overflows;
     }
 
+#if OV_USE_TIMER1
     /* Timer 1 overflow interrupt */
     if ( PIR1bits.TMR1IF )
     {
 	PIR1bits.TMR1IF = 0;
 	++Timer1_overflows;
     }
+#endif
     
+#if OV_USE_TIMER2 || OV_USE_ADC_SCAN
     /* Timer 2 overflow interrupt */
     /* Timer 2 match to PR2 (timer 2 period register) interrupt */
     if ( PIR1bits.TMR2IF )
     {
 	PIR1bits.TMR2IF = 0;
+#if OV_USE_TIMER2
 	++Timer2_overflows;
 	/*
 	 *  Timer2_overflows should hold 24 bits to extend the 8-bit timer
 	 *  but is defined as a long.
 	 */
 	Timer2_overflows &= 0x00ffffff;
+#endif
+#if OV_USE_ADC_SCAN
+	/* Background analog sampling.  See adc_scan.c. */
+	if ( Adc_scan_mask )
+	    ADCON0bits.GO = 1;
+#endif
     }
+#endif
     
+#if OV_USE_TIMER3 || OV_USE_PWM_USER
     /* Timer 3 overflow interrupt */
     if ( PIR2bits.TMR3IF )
     {
 	PIR2bits.TMR3IF = 0;
+#if OV_USE_TIMER3
 	++Timer3_overflows;
+#endif
+#if OV_USE_PWM_USER
+	/* Servo pulses for PWM_USER ports.  See pwm_user.c. */
+	if ( Pwm_user_mask && (++Pwm_user_count >= Pwm_user_period) )
+	{
+	    Pwm_user_count = 0;
+	    pwm_user_start_pulses();
+	}
+#endif
     }
+#endif
     
+#if OV_USE_TIMER4 || OV_USE_DEBOUNCE
     /* Timer 4 overflow interrupt */
     if ( PIR3bits.TMR4IF )
     {
 	PIR3bits.TMR4IF = 0;
+#if OV_USE_TIMER4
 	++Timer4_overflows;
 	/* Timer4_overflows should hold 24 bits to extend the 8-bit timer
 	 *  but is defined as a long.
 	 */
 	Timer4_overflows &= 0x00ffffff;
+#endif
+#if OV_USE_DEBOUNCE
+	/* 1ms debounce tick.  See debounce.c. */
+	if ( Debounce_mask )
+	    debounce_tick();
+#endif
     }
+#endif
+
+    /*
+     *  A/D conversion complete.  ADIF is also set by io_read_analog(),
+     *  which leaves ADIE off, so only background conversions get here.
+     */
+#if OV_USE_ADC_SCAN
+    if ( PIE1bits.ADIE && PIR1bits.ADIF )
+    {
+	PIR1bits.ADIF = 0;
+	adc_scan_complete();
+    }
+#endif
+
+    /*
+     *  Frame callback.  CCP1 is not used on the Vex, so the SPI ISR
+     *  sets CCP1IF at the end of each packet as a software interrupt
+     *  to run the callback at low priority.  This is checked last, since
+     *  the callback may take a while and the encoder and timer work
+     *  above is more urgent.
+     */
+#if OV_USE_FRAME_CALLBACK
+    if ( PIE1bits.CCP1IE && PIR1bits.CCP1IF )
+    {
+	PIR1bits.CCP1IF = 0;
+	In_frame_callback = 1;
+	Frame_callback();
+	In_frame_callback = 0;
+    }
+#endif
 }
 
 
+#if OV_USE_SONAR
 /************************************************************************
  *  Interrupt service routine for ultrasonic sensor.  This sensor
  *  transitions its digital output from 0 to 1 when the ultrasound pulse
@@ -475,8 +600,10 @@ void sonar_echo_isr(unsigned char interrupt_port)
 	Timer0_at_emit[interrupt_port-1]));
     SET_SONAR_DATA_AVAILABLE(interrupt_port);
 }
+#endif
 
 
+#if OV_USE_ENCODER_QUAD
 /****************************************************************************
  *  Process quadrature encoder interrupt on any of the 6 interrupt ports.
  *  The second line from the quadrature encoder outputs the same
@@ -570,4 +697,4 @@ void    quad_encoder_isr(unsigned char interrupt_port)
     else
 	++Encoder_ticks[interrupt_port-1];
 }
-
+#endif
@@ -46,6 +46,8 @@
 #define CLR_INTERRUPT_PORT_IN_USE(port) (Interrupt_port_in_use[(port)-1] = 0)
 
 extern unsigned char    Interrupt_port_in_use[];
+extern void             (* volatile Frame_callback)(void);
+extern volatile unsigned char   In_frame_callback;
 
 /* interrupts.c */
 void interrupt_set_edge(unsigned char port, unsigned char mask);
@@ -1,6 +1,7 @@
 /**************************************************************************
 *   
-*       Digital/Analog IO functions.
+*       Analog IO functions.  Digital IO is in io_digital.c and
+*       io_digital_mask.c.
 *
 ***************************************************************************
 *
@@ -32,10 +33,19 @@
 #include "general.h"
 #include "vex_usart.h"
 #include "io.h"
+#include "adc_scan.h"
 
 unsigned char   Analog_ports,
 		Analog_ports_const;
 
+/*
+ *  Conversion clock and acquisition time for each port.  0 selects
+ *  the defaults, so ports never passed to io_set_analog_timing() need
+ *  no initialization.  Shared with adc_scan.c.
+ */
+unsigned char   Analog_clock[TOTAL_IO_PORTS],
+		Analog_tacq[TOTAL_IO_PORTS];
+
 /**
  *  Set the number of analog ports.  On the 18F8520, we cannot arbitrarily
  *  set individual ports for analog or digital operation.  For any value of
@@ -104,6 +114,62 @@ unsigned char   io_get_analog_port_count(void)
 }
 
 
+/**
+ *  Set the conversion clock and acquisition time used when reading
+ *  an analog port.
+ *
+ *  \param  port    I/O port from 1 to 16.  Settings are kept if the
+ *                  port is later made digital and back to analog.
+ *  \param  clock   IO_ADC_CLOCK_RC (the default) or IO_ADC_CLOCK_FOSC_64.
+ *                  Fosc/64 gives the minimum legal TAD of 1.6us at
+ *                  40 MHz, converting in 19us instead of about 48us.
+ *  \param  tacq_us Time in microseconds for the ADC hold capacitor to
+ *                  charge after the channel is selected, at least
+ *                  IO_ADC_MIN_TACQ_US.  Use IO_ADC_TACQ_US() to get the
+ *                  datasheet minimum for the sensor's output
+ *                  impedance.  0 selects IO_ADC_DEFAULT_TACQ_US.
+ *
+ *  \returns    OV_OK on success, OV_BAD_PARAM if any argument is out
+ *              of range.
+ *
+ *  The defaults suit any sensor with an output impedance up to the
+ *  2.5k the datasheet recommends.  A low impedance source such as
+ *  a pot buffered by an op-amp can convert more than twice as fast:
+ *
+ *  \code
+ *  io_set_analog_timing(ARM_POT_PORT, IO_ADC_CLOCK_FOSC_64,
+ *                       IO_ADC_TACQ_US(100));
+ *  \endcode
+ *
+ *  A high impedance source needs a longer acquisition time, or the
+ *  reading will lag and depend on the previous port read:
+ *
+ *  \code
+ *  io_set_analog_timing(LIGHT_SENSOR_PORT, IO_ADC_CLOCK_RC,
+ *                       IO_ADC_TACQ_US(10000));
+ *  \endcode
+ */
+
+/*
+ * History:
+ *  Oct 2026    J Bacon
+ */
+
+status_t    io_set_analog_timing(unsigned char port, io_adc_clock_t clock,
+				 unsigned char tacq_us)
+
+{
+    if ( ! VALID_IO_PORT(port) ||
+	 ((clock != IO_ADC_CLOCK_RC) && (clock != IO_ADC_CLOCK_FOSC_64)) ||
+	 ((tacq_us != 0) && (tacq_us < IO_ADC_MIN_TACQ_US)) )
+	return OV_BAD_PARAM;
+
+    Analog_clock[port-1] = clock;
+    Analog_tacq[port-1] = tacq_us;
+    return OV_OK;
+}
+
+
 /***************************************************************************
  * Description:
  *  adc_open with SDCC 2.8 doesn't work with the VEX (pic16f8520).
@@ -169,7 +235,11 @@ void adc_conv(void)
     ADCON0bits.GO = 1;
 }
 
-char    adc_busy(void) __naked
+/*
+ *  Not __naked: a naked function gets no return instruction, so this
+ *  used to run on into whatever the compiler placed after it.
+ */
+char    adc_busy(void)
 {
     return ADCON0bits.GO;
 }
@@ -213,6 +283,12 @@ unsigned int io_read_analog(unsigned char port)
     if ( ! VALID_ANALOG_PORT(port) )
 	return OV_BAD_PARAM;
 
+    /* Sampled in the background, so no need to wait */
+    if ( Adc_scan_mask & IO_PORT_BIT(port) )
+	return adc_scan_read10(port);
+    if ( Adc_scan_mask )
+	adc_scan_pause();
+
 #ifdef __SDCC
     result = 0;
 
@@ -223,9 +299,10 @@ unsigned int io_read_analog(unsigned char port)
      *  stuff missing.
      */
     adc_open8520(channel);
+    ADCON2 = (ADCON2 & ~IO_ADC_ADCS_MASK) | IO_ADC_ADCS(Analog_clock[channel]);
 
-    /* Allow settling time before starting a conversion */
-    delay10tcy(10);
+    /* Allow the hold capacitor to charge before starting a conversion */
+    IO_ADC_ACQUIRE(Analog_tacq[channel]);
     
     adc_conv();
     while ( adc_busy() )
@@ -239,7 +316,8 @@ unsigned int io_read_analog(unsigned char port)
 
     OpenADC(ADC_FOSC_RC & ADC_RIGHT_JUST & Analog_ports_const,
 	  channel & ADC_INT_OFF & ADC_VREFPLUS_VDD & ADC_VREFMINUS_VSS);
-    Delay10TCYx(10);
+    ADCON2 = (ADCON2 & ~IO_ADC_ADCS_MASK) | IO_ADC_ADCS(Analog_clock[port-1]);
+    IO_ADC_ACQUIRE(Analog_tacq[port-1]);
     ConvertADC();
     while (BusyADC())
 	;
@@ -248,184 +326,11 @@ unsigned int io_read_analog(unsigned char port)
     result = (unsigned int)ADRESH << 8 | ADRESL;
 #endif
 
+    if ( Adc_scan_mask )
+	adc_scan_resume();
     return result;
 }
 
-/**
- *  Return the sampled value (0 or 1) from port. The port must be among those
- *  configured for digital input (see io_set_analog_port_count())
- *  and the port must have been configured for
- *  output using io_set_port_direction().
- *
- *  \param      port    The digital port to be read.
- *
- *  \returns    0 or 1 on success, OV_BAD_PARAM if the port is invalid or
- *              not configured for digital input.
- */
-
-/*
- * History:
- *  Dec 2008     J Bacon
- */
-
-unsigned char    io_read_digital(unsigned char port)
-
-{
-    if ( ! VALID_DIGITAL_INPUT_PORT(port) )
-	return OV_BAD_PARAM;
-    
-    /* DIGITAL_IN* identifiers are aliases to global PORT*bits fields */
-    switch(port)
-    {
-	case    1:  return DIGITAL_IN1;
-	case    2:  return DIGITAL_IN2;
-	case    3:  return DIGITAL_IN3;
-	case    4:  return DIGITAL_IN4;
-	case    5:  return DIGITAL_IN5;
-	case    6:  return DIGITAL_IN6;
-	case    7:  return DIGITAL_IN7;
-	case    8:  return DIGITAL_IN8;
-	case    9:  return DIGITAL_IN9;
-	case    10: return DIGITAL_IN10;
-	case    11: return DIGITAL_IN11;
-	case    12: return DIGITAL_IN12;
-	case    13: return DIGITAL_IN13;
-	case    14: return DIGITAL_IN14;
-	case    15: return DIGITAL_IN15;
-	case    16: return DIGITAL_IN16;
-	default:
-	    return OV_BAD_PARAM;
-    }
-}
-
-
-/**
- *  Set the output value of "port".  Port must be among those configured
- *  for digital I/O (see io_set_analog_port_count()) and must have been
- *  previously configured for digital output using io_set_direction().
- *  The argument "val" must be 0 or 1.
- *
- *  \param      port    Digital port to write to.
- *  \param      val     Value of 0 or 1 to write to port.
- *
- *  \returns    OV_OK on success, OV_BAD_PARAM if port is invalid or
- *              not configured for digital output.
- */
-
-/*
- * History:
- *  Dec 2008     J Bacon
- */
-
-status_t    io_write_digital(unsigned char port,unsigned char val)
-{
-    if ( ! VALID_DIGITAL_OUTPUT_PORT(port) )
-	return OV_BAD_PARAM;
-
-    /* DIGITAL_OUT* identifiers are aliases to global PORT*bits fields */
-    /* FIXME: Check IO_DIRECTION */
-    switch(port)
-    {
-	case    1:  DIGITAL_OUT1 = val; break;
-	case    2:  DIGITAL_OUT2 = val; break;
-	case    3:  DIGITAL_OUT3 = val; break;
-	case    4:  DIGITAL_OUT4 = val; break;
-	case    5:  DIGITAL_OUT5 = val; break;
-	case    6:  DIGITAL_OUT6 = val; break;
-	case    7:  DIGITAL_OUT7 = val; break;
-	case    8:  DIGITAL_OUT8 = val; break;
-	case    9:  DIGITAL_OUT9 = val; break;
-	case    10:  DIGITAL_OUT10 = val; break;
-	case    11:  DIGITAL_OUT11 = val; break;
-	case    12:  DIGITAL_OUT12 = val; break;
-	case    13:  DIGITAL_OUT13 = val; break;
-	case    14:  DIGITAL_OUT14 = val; break;
-	case    15:  DIGITAL_OUT15 = val; break;
-	case    16:  DIGITAL_OUT16 = val; break;
-	default:
-	    return OV_BAD_PARAM;
-    }
-    return OV_OK;
-}
-
-
-/**
- *  Select the direction (IO_DIRECTION_IN or IO_DIRECTION_OUT) for the given port.
- *  The port must be among those configured for digital I/O
- *  (See io_set_analog_port_count()).
- *  On the Vex, analog ports are input only.
- *
- *  \param      port    Port to configure.
- *  \param      dir     IO_DIRECTION_IN or IO_DIRECTION_OUT.
- *
- *  \returns    OV_OK on success, OV_BAD_PARAM if port is invalid
- *              or not configured for digital I/O.
- */
-
-/*
- * History:
- *  Dec 2008     J Bacon
- */
-
-status_t    io_set_direction(unsigned char port,io_dir_t dir)
-{
-    if ( ! VALID_DIGITAL_PORT(port) )
-	return OV_BAD_PARAM;
-    
-    switch(port)
-    {
-	case    1:  IO_DIRECTION1 = dir; break;
-	case    2:  IO_DIRECTION2 = dir; break;
-	case    3:  IO_DIRECTION3 = dir; break;
-	case    4:  IO_DIRECTION4 = dir; break;
-	case    5:  IO_DIRECTION5 = dir; break;
-	case    6:  IO_DIRECTION6 = dir; break;
-	case    7:  IO_DIRECTION7 = dir; break;
-	case    8:  IO_DIRECTION8 = dir; break;
-	case    9:  IO_DIRECTION9 = dir; break;
-	case    10:  IO_DIRECTION10 = dir; break;
-	case    11:  IO_DIRECTION11 = dir; break;
-	case    12:  IO_DIRECTION12 = dir; break;
-	case    13:  IO_DIRECTION13 = dir; break;
-	case    14:  IO_DIRECTION14 = dir; break;
-	case    15:  IO_DIRECTION15 = dir; break;
-	case    16:  IO_DIRECTION16 = dir; break;
-	default:
-	    return OV_BAD_PARAM;
-    }
-    return OV_OK;
-}
-
-
-unsigned char    io_get_direction(unsigned char port)
-{
-    if ( ! VALID_DIGITAL_PORT(port) )
-	return OV_BAD_PARAM;
-    
-    switch(port)
-    {
-	case    1:  return IO_DIRECTION1;
-	case    2:  return IO_DIRECTION2;
-	case    3:  return IO_DIRECTION3;
-	case    4:  return IO_DIRECTION4;
-	case    5:  return IO_DIRECTION5;
-	case    6:  return IO_DIRECTION6;
-	case    7:  return IO_DIRECTION7;
-	case    8:  return IO_DIRECTION8;
-	case    9:  return IO_DIRECTION9;
-	case    10:  return IO_DIRECTION10;
-	case    11:  return IO_DIRECTION11;
-	case    12:  return IO_DIRECTION12;
-	case    13:  return IO_DIRECTION13;
-	case    14:  return IO_DIRECTION14;
-	case    15:  return IO_DIRECTION15;
-	case    16:  return IO_DIRECTION16;
-	default:
-	    return OV_BAD_PARAM;
-    }
-}
-
-
 /****************************************************************************
  *  Set direction bits for PWMs.
  *
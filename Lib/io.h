@@ -58,6 +58,60 @@ typedef enum
     IO_DIRECTION_IN=1
 }   io_dir_t;
 
+/**
+ *  A/D conversion clock constants for use with io_set_analog_timing().
+ */
+typedef enum
+{
+    /**
+     *  The ADC's own RC oscillator, TAD about 4us
+     */
+    IO_ADC_CLOCK_RC=0,
+    
+    /**
+     *  Fosc/64, TAD 1.6us, the shortest the 18F8520 allows
+     */
+    IO_ADC_CLOCK_FOSC_64=1
+}   io_adc_clock_t;
+
+/* ADCS2:ADCS0 bits of ADCON2 for an io_adc_clock_t */
+#define IO_ADC_ADCS_MASK        0x07
+#define IO_ADC_ADCS(clock)      ((clock) == IO_ADC_CLOCK_FOSC_64 ? 0x06 : 0x07)
+
+/*
+ *  Minimum acquisition time in whole microseconds for a source impedance
+ *  of rs ohms, from the 18FXX20 datasheet at 50C:
+ *
+ *      TACQ = TAMP + TCOFF + CHOLD * (RIC + RSS + rs) * ln(2047)
+ *           = 2us + 1.25us + 120pF * (1k + 7k + rs) * 7.62
+ */
+#define IO_ADC_TACQ_US(rs) \
+    ((3250UL + (8000UL + (rs)) * 915UL / 1000UL + 999UL) / 1000UL)
+
+#define IO_ADC_MIN_TACQ_US      IO_ADC_TACQ_US(0)       /* 11us */
+#define IO_ADC_DEFAULT_TACQ_US  IO_ADC_TACQ_US(2500)    /* 13us */
+
+/*
+ *  Wait tacq microseconds, or the default if 0.  One 10-cycle unit
+ *  is 1us at 10 MIPS.
+ */
+#ifdef __SDCC
+#define IO_ADC_ACQUIRE(tacq) \
+    delay10tcy((tacq) != 0 ? (tacq) : IO_ADC_DEFAULT_TACQ_US)
+#else
+#define IO_ADC_ACQUIRE(tacq) \
+    Delay10TCYx((tacq) != 0 ? (tacq) : IO_ADC_DEFAULT_TACQ_US)
+#endif
+
+/*
+ *  Hold off low priority interrupts around a read-modify-write of a
+ *  LAT or TRIS register.  PEIE is GIEL when priorities are enabled, and
+ *  is already 0 inside the low priority ISR (e.g. in a frame callback),
+ *  so restore it rather than setting it.  Used by io_digital*.c.
+ */
+#define IO_LOW_INTS_OFF(save)       { (save) = INTCONbits.PEIE; INTCONbits.PEIE = 0; }
+#define IO_LOW_INTS_RESTORE(save)   { INTCONbits.PEIE = (save); }
+
 /*
  *  I/O pin direction control bits
  */
@@ -118,6 +172,27 @@ typedef enum
 #define DIGITAL_OUT15   LATHbits.LATH6
 #define DIGITAL_OUT16   LATHbits.LATH7
 
+/*
+ *  Unchecked digital I/O for use where the port is a compile-time
+ *  constant, such as a literal or a #define.  Each compiles to a
+ *  single bit instruction, e.g.
+ *
+ *      #define BUMPER_PORT 15
+ *      if ( IO_READ_DIGITAL(BUMPER_PORT) == DIGITAL_IN_CLOSED )
+ *
+ *  Use the io_*() functions for ports held in variables.
+ */
+#define IO_PASTE(a,b)           IO_PASTE2(a,b)
+#define IO_PASTE2(a,b)          a##b
+
+#define IO_READ_DIGITAL(port)           IO_PASTE(DIGITAL_IN,port)
+#define IO_WRITE_DIGITAL(port,val)      (IO_PASTE(DIGITAL_OUT,port) = (val))
+#define IO_GET_DIRECTION(port)          IO_PASTE(IO_DIRECTION,port)
+#define IO_SET_DIRECTION(port,dir)      (IO_PASTE(IO_DIRECTION,port) = (dir))
+
+/* Bit for port in io_read_digital_all() and io_write_digital_mask() */
+#define IO_PORT_BIT(port)               ((unsigned short)1 << ((port)-1))
+
 /*
  *  Interrupt pin mappings
  */
@@ -202,12 +277,20 @@ typedef enum
 /* io.c */
 status_t io_set_analog_port_count(unsigned char number_of_ports);
 unsigned char io_get_analog_port_count(void);
+status_t io_set_analog_timing(unsigned char port, io_adc_clock_t clock,
+			      unsigned char tacq_us);
 unsigned int io_read_analog(unsigned char port);
+void io_update_local_pwm_dir(unsigned char txPWM_MASK);
+
+/* io_digital.c */
 unsigned char io_read_digital(unsigned char port);
 status_t io_write_digital(unsigned char port, unsigned char val);
 status_t io_set_direction(unsigned char port, io_dir_t dir);
 unsigned char    io_get_direction(unsigned char port);
-void io_update_local_pwm_dir(unsigned char txPWM_MASK);
+
+/* io_digital_mask.c */
+unsigned short io_read_digital_all(void);
+void io_write_digital_mask(unsigned short mask, unsigned short value);
 
 #endif
 
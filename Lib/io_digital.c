@@ -0,0 +1,192 @@
+/**************************************************************************
+*
+*   Digital I/O functions.  Kept apart from the analog functions in
+*   io.c so that a program only links the ones it calls.
+*
+***************************************************************************
+*
+*   This code is free software: you can redistribute it and/or modify
+*   it under the terms of the GNU General Public License as published by
+*   the Free Software Foundation, either version 3 of the License, or
+*   (at your option) any later version.
+*
+*   This code is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License
+*   along with this code.  If not, see <http://www.gnu.org/licenses/>.
+*
+***************************************************************************/
+
+#include "platform.h"
+#include "general.h"
+#include "io.h"
+
+extern unsigned char    Analog_ports;
+
+/**
+ *  \addtogroup IO
+ *  @{
+ */
+
+/*
+ *  Low byte of the PORTx address and the bit mask for each digital
+ *  port, so that the functions below can find any port with two table
+ *  lookups instead of a 16-case switch.  The LATx and TRISx registers
+ *  are at fixed offsets from PORTx.
+ */
+#define IO_SFR_BASE     0xf00
+#define IO_PORTA_LOW    0x80    /* PORTA = 0xf80 */
+#define IO_PORTF_LOW    0x85
+#define IO_PORTH_LOW    0x87
+#define IO_LAT_OFFSET   0x09    /* LATA = 0xf89 */
+#define IO_TRIS_OFFSET  0x12    /* TRISA = 0xf92 */
+
+#define IO_PORT_SFR(port) \
+    ((volatile unsigned char DATA *)(IO_SFR_BASE | Io_port_sfr[(port)-1]))
+
+static const ROM unsigned char  Io_port_sfr[TOTAL_IO_PORTS] =
+{
+    IO_PORTA_LOW, IO_PORTA_LOW, IO_PORTA_LOW, IO_PORTA_LOW, IO_PORTA_LOW,
+    IO_PORTF_LOW, IO_PORTF_LOW, IO_PORTF_LOW, IO_PORTF_LOW,
+    IO_PORTF_LOW, IO_PORTF_LOW, IO_PORTF_LOW,
+    IO_PORTH_LOW, IO_PORTH_LOW, IO_PORTH_LOW, IO_PORTH_LOW
+};
+
+static const ROM unsigned char  Io_port_mask[TOTAL_IO_PORTS] =
+{
+    0x01, 0x02, 0x04, 0x08, 0x20,
+    0x01, 0x02, 0x04, 0x08, 0x10, 0x20, 0x40,
+    0x10, 0x20, 0x40, 0x80
+};
+
+/**
+ *  Return the sampled value (0 or 1) from port. The port must be among those
+ *  configured for digital input (see io_set_analog_port_count())
+ *  and the port must have been configured for
+ *  output using io_set_port_direction().
+ *
+ *  \param      port    The digital port to be read.
+ *
+ *  \returns    0 or 1 on success, OV_BAD_PARAM if the port is invalid or
+ *              not configured for digital input.
+ */
+
+/*
+ * History:
+ *  Dec 2008     J Bacon
+ */
+
+unsigned char    io_read_digital(unsigned char port)
+
+{
+    volatile unsigned char DATA *sfr;
+    unsigned char   mask;
+    
+    if ( ! VALID_DIGITAL_PORT(port) )
+	return OV_BAD_PARAM;
+    
+    sfr = IO_PORT_SFR(port);
+    mask = Io_port_mask[port-1];
+    if ( ! (sfr[IO_TRIS_OFFSET] & mask) )
+	return OV_BAD_PARAM;
+    return (*sfr & mask) != 0;
+}
+
+
+/**
+ *  Set the output value of "port".  Port must be among those configured
+ *  for digital I/O (see io_set_analog_port_count()) and must have been
+ *  previously configured for digital output using io_set_direction().
+ *  The argument "val" must be 0 or 1.
+ *
+ *  \param      port    Digital port to write to.
+ *  \param      val     Value of 0 or 1 to write to port.
+ *
+ *  \returns    OV_OK on success, OV_BAD_PARAM if port is invalid or
+ *              not configured for digital output.
+ */
+
+/*
+ * History:
+ *  Dec 2008     J Bacon
+ */
+
+status_t    io_write_digital(unsigned char port,unsigned char val)
+{
+    volatile unsigned char DATA *sfr;
+    unsigned char   mask,
+		    ints;
+    
+    if ( ! VALID_DIGITAL_PORT(port) )
+	return OV_BAD_PARAM;
+
+    sfr = IO_PORT_SFR(port);
+    mask = Io_port_mask[port-1];
+    if ( sfr[IO_TRIS_OFFSET] & mask )
+	return OV_BAD_PARAM;
+
+    /* Unlike bsf/bcf, this read-modify-write could be interrupted */
+    IO_LOW_INTS_OFF(ints);
+    if ( val )
+	sfr[IO_LAT_OFFSET] |= mask;
+    else
+	sfr[IO_LAT_OFFSET] &= ~mask;
+    IO_LOW_INTS_RESTORE(ints);
+    return OV_OK;
+}
+
+
+/**
+ *  Select the direction (IO_DIRECTION_IN or IO_DIRECTION_OUT) for the given port.
+ *  The port must be among those configured for digital I/O
+ *  (See io_set_analog_port_count()).
+ *  On the Vex, analog ports are input only.
+ *
+ *  \param      port    Port to configure.
+ *  \param      dir     IO_DIRECTION_IN or IO_DIRECTION_OUT.
+ *
+ *  \returns    OV_OK on success, OV_BAD_PARAM if port is invalid
+ *              or not configured for digital I/O.
+ */
+
+/*
+ * History:
+ *  Dec 2008     J Bacon
+ */
+
+status_t    io_set_direction(unsigned char port,io_dir_t dir)
+{
+    volatile unsigned char DATA *sfr;
+    unsigned char   mask,
+		    ints;
+    
+    if ( ! VALID_DIGITAL_PORT(port) )
+	return OV_BAD_PARAM;
+    
+    sfr = IO_PORT_SFR(port);
+    mask = Io_port_mask[port-1];
+    IO_LOW_INTS_OFF(ints);
+    if ( dir == IO_DIRECTION_IN )
+	sfr[IO_TRIS_OFFSET] |= mask;
+    else
+	sfr[IO_TRIS_OFFSET] &= ~mask;
+    IO_LOW_INTS_RESTORE(ints);
+    return OV_OK;
+}
+
+
+OV_INLINE unsigned char  io_get_direction(unsigned char port)
+{
+    if ( ! VALID_DIGITAL_PORT(port) )
+	return OV_BAD_PARAM;
+    
+    if ( IO_PORT_SFR(port)[IO_TRIS_OFFSET] & Io_port_mask[port-1] )
+	return IO_DIRECTION_IN;
+    else
+	return IO_DIRECTION_OUT;
+}
+
+/** @} */
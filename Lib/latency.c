@@ -0,0 +1,267 @@
+/**************************************************************************
+*
+*   RC-to-motor latency instrumentation.
+*
+*   A joystick change reaches the motors through several hands: the SPI
+*   ISR receives it and flips the rx double buffer, the user code finds
+*   it with rc_new_data_available(), computes a response and calls
+*   controller_submit_data(), and the SPI ISR finally sends the tx
+*   buffer to the master at the start of a later packet.  These
+*   functions timestamp each hand-off with Timer0 and keep min, mean,
+*   max and a histogram for each stage.
+*
+*   The SPI ISR only takes timestamps.  All arithmetic is done here in
+*   user context, so enabling the statistics does not lengthen the
+*   per-byte SPI interrupt.
+*
+***************************************************************************
+*
+*   This code is free software: you can redistribute it and/or modify
+*   it under the terms of the GNU General Public License as published by
+*   the Free Software Foundation, either version 3 of the License, or
+*   (at your option) any later version.
+*
+*   This code is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License
+*   along with this code.  If not, see <http://www.gnu.org/licenses/>.
+*
+***************************************************************************/
+
+#include <string.h>
+#include "platform.h"
+#include "vex_usart.h"
+#include "timer.h"
+#include "latency.h"
+#include "ov_printf.h"
+
+/* Shared with the SPI ISR in vex_spi.c */
+volatile unsigned char  Latency_enabled = 0;
+volatile unsigned char  Latency_tx_pending = LATENCY_IDLE;
+volatile unsigned short Latency_rx_time;    /* End of last rx packet */
+volatile unsigned short Latency_tx_time;    /* Start of submitted tx */
+
+static latency_stage_t  Latency_stage[LATENCY_STAGES];
+
+/* Timestamps of the frame currently being followed */
+static unsigned short   Chain_rx_time;
+static unsigned short   Chain_user_time;
+static unsigned short   Chain_submit_time;
+static unsigned char    Chain_active = 0;
+
+/*
+ *  Both ISRs read TMR0L, which reloads the TMR0H buffer, so don't
+ *  let them in between our two reads.  GIE is restored rather than
+ *  set, in case the caller already had interrupts off.
+ */
+#define LATENCY_STAMP(v, save) \
+{ \
+    (save) = INTCONbits.GIE; \
+    INTCONbits.GIE = 0; \
+    TIMER0_READ16(v); \
+    INTCONbits.GIE = (save); \
+}
+
+/*
+ *  A Timer0 tick is prescale / 10 microseconds.  205 / 2048 is within
+ *  0.1% of 1/10, so ticks convert to microseconds with a multiply and a
+ *  shift instead of a 32-bit division.  Even at prescale 256, 65535
+ *  ticks times the scale fits in an unsigned long.
+ */
+#define LATENCY_SCALE_MUL       205
+#define LATENCY_SCALE_SHIFT     11
+#define LATENCY_US(ticks, scale) \
+    (((unsigned long)(ticks) * (scale)) >> LATENCY_SCALE_SHIFT)
+
+static void latency_record(unsigned char stage, unsigned short ticks);
+
+/**
+ *  \defgroup latency RC to Motor Latency
+ *  @{
+ *
+ *  Measure how long it takes for RC input to reach the motors.
+ *  Call latency_start() once Timer0 is running (i.e. after
+ *  controller_init()) and latency_report() whenever a summary is
+ *  wanted.  Four stages are reported:
+ *
+ *  0: Packet received to rc_new_data_available() returning TRUE\n
+ *  1: rc_new_data_available() to controller_submit_data()\n
+ *  2: controller_submit_data() to the SPI ISR sending the data\n
+ *  3: Total, packet received to response sent
+ *
+ *  Stage 0 shows how long the main loop takes to notice new data.
+ *  A total above one frame (18.5ms) means the response missed the
+ *  next packet.  See also rc_set_frame_callback().
+ */
+
+/**
+ *  Clear latency statistics and begin collecting.
+ */
+
+/*
+ * History:
+ *  Oct 2026    J Bacon
+ */
+
+void    latency_start(void)
+
+{
+    unsigned char   s;
+
+    Latency_enabled = 0;
+    memset(Latency_stage, 0, sizeof(Latency_stage));
+    for (s = 0; s < LATENCY_STAGES; ++s)
+	Latency_stage[s].min = 0xffff;
+    Chain_active = 0;
+    Latency_tx_pending = LATENCY_IDLE;
+    Latency_enabled = 1;
+}
+
+
+/**
+ *  Stop collecting latency statistics.  The results so far are kept
+ *  for latency_report().
+ */
+
+/*
+ * History:
+ *  Oct 2026    J Bacon
+ */
+
+void    latency_stop(void)
+
+{
+    Latency_enabled = 0;
+    Latency_tx_pending = LATENCY_IDLE;
+}
+
+
+/**
+ *  Print latency statistics for all stages to the serial port.
+ *  Times are in microseconds, converted using the current Timer0
+ *  prescale.  Histogram columns are in Timer0 ticks, under 256, 512,
+ *  ... 16384 and 16384 or more, which at the default prescale of 16
+ *  is under 0.4, 0.8, 1.6, 3.3, 6.6, 13.1, 26.2ms and 26.2ms or more.
+ */
+
+/*
+ * History:
+ *  Oct 2026    J Bacon
+ */
+
+void    latency_report(void)
+
+{
+    unsigned char       s, b;
+    latency_stage_t     *st;
+    unsigned long       mean;
+    unsigned short      scale;
+
+    scale = (unsigned short)TIMER0_PRESCALE * LATENCY_SCALE_MUL;
+    ov_printf("Latency (us)  count    min   mean    max  histogram\n");
+    for (s = 0; s < LATENCY_STAGES; ++s)
+    {
+	st = &Latency_stage[s];
+	mean = st->count ? st->sum / st->count : 0;
+	ov_printf("  stage %d  %6u %6lu %6lu %6lu ", (int)s, st->count,
+	    st->count ? LATENCY_US(st->min, scale) : 0UL,
+	    LATENCY_US(mean, scale), LATENCY_US(st->max, scale));
+	for (b = 0; b < LATENCY_BINS; ++b)
+	    ov_printf(" %u", st->histogram[b]);
+	ov_putc('\n');
+    }
+}
+
+
+/*
+ *  Called by rc_new_data_available() when it returns TRUE.  Starts
+ *  following a new frame, after finishing the previous one if the SPI
+ *  ISR has sent its response since.
+ *
+ * History:
+ *  Oct 2026    J Bacon
+ */
+
+void    latency_user_saw_frame(void)
+
+{
+    unsigned short  now;
+    unsigned char   gie;
+
+    LATENCY_STAMP(now, gie);
+    if ( Latency_tx_pending == LATENCY_SENT )
+    {
+	/* Recorded here to keep latency_user_submitted() short */
+	latency_record(LATENCY_USER_TO_SUBMIT,
+	    Chain_submit_time - Chain_user_time);
+	latency_record(LATENCY_SUBMIT_TO_TX,
+	    Latency_tx_time - Chain_submit_time);
+	latency_record(LATENCY_TOTAL, Latency_tx_time - Chain_rx_time);
+	Latency_tx_pending = LATENCY_IDLE;
+    }
+
+    /* Still waiting for the ISR to send the last one, so skip this */
+    if ( Latency_tx_pending != LATENCY_IDLE )
+	return;
+
+    /* Only the ISR writes it, and it won't again for almost 18.5ms */
+    Chain_rx_time = Latency_rx_time;
+    Chain_user_time = now;
+    Chain_active = 1;
+    latency_record(LATENCY_RX_TO_USER, now - Chain_rx_time);
+}
+
+
+/*
+ *  Called by controller_submit_data() with SSPIE off, right after it
+ *  toggles the tx buffers, so that the SPI ISR sees LATENCY_SUBMITTED
+ *  no later than the new data.  Only the first submit after a frame
+ *  is seen counts as the response to it.  The stage times are
+ *  recorded by latency_user_saw_frame() once the ISR has sent it.
+ *
+ * History:
+ *  Oct 2026    J Bacon
+ */
+
+void    latency_user_submitted(void)
+
+{
+    unsigned char   gie;
+
+    if ( ! Chain_active )
+	return;
+    LATENCY_STAMP(Chain_submit_time, gie);
+    Chain_active = 0;
+    Latency_tx_pending = LATENCY_SUBMITTED;
+}
+
+
+/*
+ * History:
+ *  Oct 2026    J Bacon
+ */
+
+static void latency_record(unsigned char stage, unsigned short ticks)
+
+{
+    latency_stage_t *st = &Latency_stage[stage];
+    unsigned char   bin;
+    unsigned short  limit;
+
+    ++st->count;
+    st->sum += ticks;
+    if ( ticks < st->min )
+	st->min = ticks;
+    if ( ticks > st->max )
+	st->max = ticks;
+
+    for (bin = 0, limit = LATENCY_BIN0_TICKS;
+	    (bin < LATENCY_BINS - 1) && (ticks >= limit); ++bin)
+	limit <<= 1;
+    ++st->histogram[bin];
+}
+
+/** @} */
@@ -0,0 +1,66 @@
+/**************************************************************************
+* Description:
+*   RC-to-motor latency instrumentation.
+*
+***************************************************************************
+*
+*   This code is free software: you can redistribute it and/or modify
+*   it under the terms of the GNU General Public License as published by
+*   the Free Software Foundation, either version 3 of the License, or
+*   (at your option) any later version.
+*
+*   This code is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License
+*   along with this code.  If not, see <http://www.gnu.org/licenses/>.
+*
+***************************************************************************/
+
+#ifndef __latency_h__
+#define __latency_h__
+
+/* Stages of the path from an RC packet to the PWM packet answering it */
+#define LATENCY_RX_TO_USER      0   /* Packet in to rc_new_data_available() */
+#define LATENCY_USER_TO_SUBMIT  1   /* ... to controller_submit_data() */
+#define LATENCY_SUBMIT_TO_TX    2   /* ... to SPI ISR sending it */
+#define LATENCY_TOTAL           3   /* Packet in to response going out */
+#define LATENCY_STAGES          4
+
+/*
+ *  Histogram bins double in width: bin 0 is under 256 Timer0 ticks
+ *  (0.41ms at prescale 16), bin 1 under 512, ... and the last bin
+ *  holds everything from 26.2ms up.
+ */
+#define LATENCY_BINS            8
+#define LATENCY_BIN0_TICKS      256
+
+/* Latency_tx_pending states, shared with the SPI ISR */
+#define LATENCY_IDLE            0
+#define LATENCY_SUBMITTED       1
+#define LATENCY_SENT            2
+
+typedef struct
+{
+    unsigned int    count;
+    unsigned int    min;        /* Timer0 ticks */
+    unsigned int    max;
+    unsigned long   sum;
+    unsigned int    histogram[LATENCY_BINS];
+}   latency_stage_t;
+
+extern volatile unsigned char   Latency_enabled;
+extern volatile unsigned char   Latency_tx_pending;
+extern volatile unsigned short  Latency_rx_time;
+extern volatile unsigned short  Latency_tx_time;
+
+/* latency.c */
+void latency_start(void);
+void latency_stop(void);
+void latency_report(void);
+void latency_user_saw_frame(void);
+void latency_user_submitted(void);
+
+#endif
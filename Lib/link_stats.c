@@ -0,0 +1,120 @@
+/**************************************************************************
+*
+*   Statistics for the SPI link between the master and user processors.
+*   The counters are updated by the SPI ISR in vex_spi.c as each packet
+*   completes, so keeping them costs only a few instructions per 18.5ms
+*   frame.
+*
+***************************************************************************
+*
+*   This code is free software: you can redistribute it and/or modify
+*   it under the terms of the GNU General Public License as published by
+*   the Free Software Foundation, either version 3 of the License, or
+*   (at your option) any later version.
+*
+*   This code is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License
+*   along with this code.  If not, see <http://www.gnu.org/licenses/>.
+*
+***************************************************************************/
+
+#include "platform.h"
+#include "vex_usart.h"
+#include "link_stats.h"
+#include "ov_printf.h"
+
+/**
+ *  \defgroup link_stats SPI Link Statistics
+ *  @{
+ *
+ *  The master processor sends a packet to the user processor every
+ *  18.5ms.  These functions report how many packets arrived, how many
+ *  were lost or repeated on the link, and how many arrived before the
+ *  user code had looked at the previous one.  A steadily rising
+ *  user_missed count means the main loop is too slow to keep up with
+ *  the remote control.
+ */
+
+/**
+ *  Copy the current link statistics.
+ *
+ *  \param  stats   Address of structure to receive the counters.
+ */
+
+/*
+ * History:
+ *  Oct 2026    J Bacon
+ */
+
+void    link_stats_read(link_stats_t *stats)
+
+{
+    /*
+     *  Masking SSPIE for the whole copy could hold off the next SPI
+     *  byte long enough to cause the overflows counted here.  The ISR
+     *  updates every counter together with frames at the end of a
+     *  packet, so instead copy until frames is the same afterwards.
+     */
+    do
+    {
+	stats->frames = Link_stats.frames;
+	stats->missed_packets = Link_stats.missed_packets;
+	stats->duplicate_packets = Link_stats.duplicate_packets;
+	stats->overflows = Link_stats.overflows;
+	stats->collisions = Link_stats.collisions;
+	stats->user_missed = Link_stats.user_missed;
+    }   while ( stats->frames != Link_stats.frames );
+}
+
+
+/**
+ *  Reset all link statistics to zero.
+ */
+
+/*
+ * History:
+ *  Oct 2026    J Bacon
+ */
+
+void    link_stats_clear(void)
+
+{
+    volatile unsigned int DATA  *p = (volatile unsigned int DATA *)&Link_stats;
+    unsigned char               sspie = PIE1bits.SSPIE;
+
+    /* One counter per store, so SSPIE is only off for a few cycles */
+    for (; p < (volatile unsigned int DATA *)(&Link_stats + 1); ++p)
+    {
+	PIE1bits.SSPIE = 0;
+	*p = 0;
+	PIE1bits.SSPIE = sspie;
+    }
+}
+
+
+/**
+ *  Print link statistics on one line to the serial port.  This is
+ *  meant to be added to a program's periodic status output.
+ */
+
+/*
+ * History:
+ *  Oct 2026    J Bacon
+ */
+
+void    link_stats_print(void)
+
+{
+    link_stats_t    stats;
+
+    link_stats_read(&stats);
+    ov_printf("Link: frames %u missed %u dup %u ovf %u wcol %u late %u\n",
+	stats.frames, stats.missed_packets, stats.duplicate_packets,
+	stats.overflows, stats.collisions, stats.user_missed);
+}
+
+/** @} */
@@ -0,0 +1,46 @@
+/**************************************************************************
+* Description:
+*   Statistics for the SPI link between the master and user processors.
+*
+***************************************************************************
+*
+*   This code is free software: you can redistribute it and/or modify
+*   it under the terms of the GNU General Public License as published by
+*   the Free Software Foundation, either version 3 of the License, or
+*   (at your option) any later version.
+*
+*   This code is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License
+*   along with this code.  If not, see <http://www.gnu.org/licenses/>.
+*
+***************************************************************************/
+
+#ifndef __link_stats_h__
+#define __link_stats_h__
+
+/*
+ *  Counters are maintained by the SPI ISR (InterruptHandlerHigh) and
+ *  wrap at 65535.  Use link_stats_read() to get a consistent copy.
+ */
+typedef struct
+{
+    unsigned int    frames;             /* Packets received from master */
+    unsigned int    missed_packets;     /* Gaps in master packet_num */
+    unsigned int    duplicate_packets;  /* Repeated master packet_num */
+    unsigned int    overflows;          /* Packets with SSPOV set */
+    unsigned int    collisions;         /* Packets with WCOL set */
+    unsigned int    user_missed;        /* Frames never seen by user code */
+}   link_stats_t;
+
+extern volatile link_stats_t    Link_stats;
+
+/* link_stats.c */
+void link_stats_read(link_stats_t *stats);
+void link_stats_clear(void);
+void link_stats_print(void);
+
+#endif
@@ -26,7 +26,6 @@
 *
 ***************************************************************************/
 
-#include <stdio.h>
 #include <string.h>
 #include "platform.h"
 #include "vex_usart.h"
@@ -34,9 +33,22 @@
 #include "vex_spi.h"
 #include "general.h"
 #include "master.h"
+#include "interrupts.h"
+#include "latency.h"
+#include "pwm_user.h"
+#include "pwm_output.h"
+#include "mem_monitor.h"
+#include "ov_printf.h"
 
 unsigned char                   Pwm_disable_mask;
 
+/* Decoded once per frame by rc_new_data_available() */
+rc_snapshot_t                   Rc_snapshot;
+static unsigned char            Rc_deadband[TOTAL_RC_CHANNELS];
+static unsigned char            Rc_expo[TOTAL_RC_CHANNELS];
+
+static void rc_decode(void);
+
 /************************************************************************
  *  rx_data_t functions
  *  These functions read data from the rxdata structure, which is
@@ -75,6 +87,22 @@ unsigned char    rc_read_status(void)
  *  For buttons, 0 indicates that neither button for the channel is
  *  pressed, -127 indicates the lower button, and 127 indicates the upper.
  *
+ *  The value comes from a snapshot decoded once per frame when
+ *  rc_new_data_available() returns TRUE, with any deadband and expo
+ *  set by rc_set_deadband() and rc_set_expo() already applied.
+ *  Calling this many times per frame costs no more than a validated
+ *  array access.  Code that knows the channel is valid can use
+ *  RC_READ_DATA() instead.
+ *
+ *  Only rc_new_data_available() decodes the snapshot; the SPI ISR and
+ *  controller_submit_data(), even with WAIT, do not.  A program must
+ *  therefore poll rc_new_data_available() every frame (or read from
+ *  a frame callback, which does so itself) to see the sticks move.
+ *  Without that, this keeps returning the values decoded by the last
+ *  call, which after controller_init() are those of the first frame.
+ *  Older versions read the latest packet directly, so programs that
+ *  never called rc_new_data_available() must now add the call.
+ *
  *  \param  channel Channel (joystick axis or button pair) to read.
  *  
  *  \returns    Value read from channel (-127 to +127)
@@ -83,111 +111,85 @@ unsigned char    rc_read_status(void)
 /*
  * History:
  *  Dec 2008     J Bacon
+ *  Oct 2026     J Bacon     Read from per-frame snapshot
  */
 
-signed char    rc_read_data(unsigned char channel)
+OV_INLINE signed char  rc_read_data(unsigned char channel)
 {
-    /* RC_CHANNEL* identifiers are aliases to global PORT*bits fields */
     if ( VALID_RC_CHANNEL(channel) )
-    {
-	/* 
-	 *  Master returns 0 for full left/down, 127 for center, 255 for
-	 *  full right/up.  We want 0 to be center, so we subtract 127.
-	 *  255 is a special case, since 255 - 127 = +128, which is
-	 *  interpreted as -128 in signed char format.  This is at the
-	 *  wrong end of the spectrum, so we simply eliminate this
-	 *  rogue value.  Had the designers chosen 128 as the center
-	 *  position, we would not have this issue.
-	 */
-	if ( User_rxdata->oi_analog[channel-1] == 255 )
-	    --User_rxdata->oi_analog[channel-1];
-	return User_rxdata->oi_analog[channel-1] - 127;
-    }
+	return RC_READ_DATA(channel);
     else
 	return OV_BAD_PARAM;
 }
 
 
 /**
- *  Return a value indicating a binary sequence on RC button 'channel'.
- *  This function allows a single button pair to be used to trigger up to
- *  127 different actions.
+ *  Set a deadband around center for an RC channel.  Readings within
+ *  deadband of center are reported as 0, and readings outside it are
+ *  rescaled so that full stick still reads +/-127.  This keeps
+ *  joystick trim and drift from creeping the motors.
  *
- *  This function keeps a static internal value and counter.
- *  Each time this function is called, the buttons on channel are
- *  sampled.  If the lower button is pressed, a 0 is inserted into least
- *  significant bit of the value, and the counter incremented.  If the
- *  upper button is pressed, a 1 is inserted and the counter is incremented.
- *  If neither button is pressed, neither the value nor counter are changed.
+ *  \param  channel     RC channel, 1 to 6.
+ *  \param  deadband    Half-width of the dead zone, 0 (none) to 126.
  *
- *  A button being held down will only be counted once.  It must be released
- *  and pressed again to advance the sequence.
+ *  \returns    OV_OK on success, OV_BAD_PARAM if either argument
+ *              is invalid.
  *
- *  When the counter reaches 'len', the function returns the value
- *  based on the binary sequence of button presses.  For example, if
- *  the sequence length is 3, and the user presses the sequence
- *  lower, upper, upper, then the value returned is 011 binary
- *  (3 in decimal).
+ *  Takes effect with the next frame.
+ */
+
+/*
+ * History:
+ *  Oct 2026     J Bacon
+ */
+
+status_t    rc_set_deadband(unsigned char channel, unsigned char deadband)
+
+{
+    if ( ! VALID_RC_CHANNEL(channel) || (deadband > 126) )
+	return OV_BAD_PARAM;
+    Rc_deadband[channel-1] = deadband;
+    return OV_OK;
+}
+
+
+/**
+ *  Set an exponential response curve for an RC channel.  The curve
+ *  is a blend of linear and cubic response, which gives finer
+ *  control near center while still reaching full power at full stick.
  *
- *  Until then, it returns -1, indicating that the sequence is not
- *  yet complete.
+ *  \param  channel RC channel, 1 to 6.
+ *  \param  expo    Amount of cubic response, 0 (linear) to 127
+ *                  (pure cubic).
  *
- *  \param  channel Channel of button pair to read.
- *  \param  len     Length of button sequence.
+ *  \returns    OV_OK on success, OV_BAD_PARAM if either argument
+ *              is invalid.
  *
- *  \returns    -1 if sequence is not complete, or value of binary sequence.
+ *  Takes effect with the next frame.  Expo adds some 32 bit math
+ *  to the per-frame decode of the channel, so leave it at 0 for
+ *  button channels.
  */
 
-signed char   rc_button_sequence(unsigned char channel, unsigned char len)
+/*
+ * History:
+ *  Oct 2026     J Bacon
+ */
+
+status_t    rc_set_expo(unsigned char channel, unsigned char expo)
 
 {
-    static unsigned char    count = 0,
-			    val = 0,
-			    temp,
-			    digit;
-    static signed char      button,
-			    old_button;
-
-    if ( ! VALID_RC_CHANNEL(channel) )
+    if ( ! VALID_RC_CHANNEL(channel) || (expo > 127) )
 	return OV_BAD_PARAM;
-
-    switch ( button = rc_read_data(channel) )
-    {
-	case    -127:
-	    digit = 0;
-	    break;
-	case    +127:
-	    digit = 1;
-	    break;
-	default:
-	    digit = 2;
-	    break;
-    }
-    
-    /*
-     *  Register only distinct button pressed.  This function could be
-     *  called thousands of times while a button is being held down,
-     *  but this does not constitute a button sequence.
-     */
-    if ( (digit < 2) && (button != old_button) )
-    {
-	++count;
-	val = (val << 1) + digit;     /* Insert new digit in LSB */
-    }
-    old_button = button;
-    if ( count == len )
-    {
-	temp = val;
-	count = val = 0;
-	return temp;
-    }
-    else
-	return OV_SEQUENCE_INCOMPLETE;
+    Rc_expo[channel-1] = expo;
+    return OV_OK;
 }
 
 
 /**
  *  Determine whether new data is available from the remote control unit.
+ *  While a frame callback is installed, each frame belongs to the
+ *  callback, so this returns FALSE everywhere else.  See
+ *  rc_set_frame_callback().
  *
  *  \returns    TRUE when new data is available, FALSE if not.
  */
@@ -200,6 +202,7 @@ signed char   rc_button_sequence(unsigned char channel, unsigned char len)
  *  Dec 2008    J Bacon     Derived from Vex default code.
  *  May 2009    J Bacon     Rewrote double-buffer mechanism to eliminate
  *                          mem copy to third buffer.
+ *  Oct 2026    J Bacon     Leave frames to an installed frame callback.
  ***************************************************************************/
 
 unsigned char   rc_new_data_available(void)
@@ -207,6 +210,15 @@ unsigned char   rc_new_data_available(void)
 {
     unsigned char   new_rc_data;
     
+    /*
+     *  rc_decode() is not reentrant, so the main loop must not run
+     *  it while the callback may interrupt.  Only the main loop
+     *  changes Frame_callback, so this test can't race with it.
+     */
+    if ( OV_USE_FRAME_CALLBACK && (Frame_callback != NULL) &&
+	 ! In_frame_callback )
+	return FALSE;
+
     new_rc_data = Spi_status.new_rc_data;
     if ( new_rc_data )
     {
@@ -218,6 +230,11 @@ unsigned char   rc_new_data_available(void)
 	MASTER_CLR_NEW_RC_DATA_FLAG(Spi_status);
 	PIE1bits.SSPIE = 1;
 
+	rc_decode();
+
+	if ( Latency_enabled )
+	    latency_user_saw_frame();
+
 	// Pwm_disable_mask will be 0 unless USER_CPP is in use
 	// for some ports.
 	// if (Pwm_disable_mask != 0x0f)
@@ -226,6 +243,135 @@ unsigned char   rc_new_data_available(void)
     return new_rc_data;
 }
 
+
+/**
+ *  Register a function to be called as soon as each new packet
+ *  arrives from the master processor.
+ *
+ *  \param  callback    Function to call, or NULL to stop callbacks.
+ *
+ *  Polling rc_new_data_available() from the main loop adds up to
+ *  one loop iteration of delay between the arrival of RC data and the
+ *  controller_submit_data() that sends the response.  If the response
+ *  misses the next packet, the motors lag the joystick by an extra
+ *  18.5ms frame.  The callback runs within microseconds of the end
+ *  of the packet, so its output is always picked up by the next one.
+ *
+ *  The callback runs in the low-priority interrupt handler, so while
+ *  it runs, shaft encoder, sonar and timer interrupts are held off.
+ *  It should therefore be short, and should not print.  It should
+ *  call rc_new_data_available() to acknowledge the frame, and is
+ *  the natural place for rc_read_data(), pwm_write() and
+ *  controller_submit_data(NO_WAIT).  Never use WAIT here, since the
+ *  next packet cannot be acknowledged until the callback returns.
+ *  If the callback submits data, the main loop should not.
+ *
+ *  controller_submit_data(WAIT) from the main loop is safe while a
+ *  callback is installed.  It watches the SPI ISR for the packet
+ *  carrying the data rather than calling rc_new_data_available().
+ *  If the callback also submits, install NULL first, e.g. around
+ *  controller_begin_autonomous_mode(), since both would be in
+ *  controller_submit_data() at once.
+ *
+ *  Under SDCC, library functions keep their locals in static RAM, so
+ *  one called from the callback must not also be called from the main
+ *  loop, or the callback can overwrite them mid-call.  While a
+ *  callback is installed, rc_new_data_available() returns FALSE
+ *  outside it, so a main loop that polls it simply stops seeing
+ *  frames.  The main loop must not call rc_read_data() either, but
+ *  can use values the callback saves in volatile variables.
+ *
+ *  Example:
+ *  \code
+ *  void    drive_callback(void)
+ *  {
+ *      rc_new_data_available();
+ *      pwm_write(LEFT_DRIVE_PORT, rc_read_data(3));
+ *      pwm_write(RIGHT_DRIVE_PORT, -rc_read_data(2));
+ *      controller_submit_data(NO_WAIT);
+ *  }
+ *
+ *  rc_set_frame_callback(drive_callback);
+ *  \endcode
+ */
+
+/*
+ * History:
+ *  Oct 2026    J Bacon
+ */
+
+void    rc_set_frame_callback(void (*callback)(void))
+
+{
+    /* Don't let the ISR call through a half-written pointer */
+    PIE1bits.CCP1IE = 0;
+    Frame_callback = callback;
+    /* Nothing would clear CCP1IF.  See openvex_config.h. */
+    if ( OV_USE_FRAME_CALLBACK && (callback != NULL) )
+    {
+	/* Drop any stale request so the first call is for a new frame */
+	PIR1bits.CCP1IF = 0;
+	PIE1bits.CCP1IE = 1;
+    }
+}
+
+
+/*
+ *  Convert all RC channels in the current rx buffer into Rc_snapshot.
+ *  The rx buffer itself is left untouched, since it belongs to the
+ *  SPI ISR.
+ *
+ * History:
+ *  Oct 2026     J Bacon
+ */
+
+static void rc_decode(void)
+
+{
+    volatile rx_data_t  *rx = User_rxdata;
+    unsigned char       c,
+			raw,
+			db;
+    int                 val;
+    long                cube;
+
+    for (c = 0; c < TOTAL_RC_CHANNELS; ++c)
+    {
+	/* 
+	 *  Master returns 0 for full left/down, 127 for center, 255 for
+	 *  full right/up.  We want 0 to be center, so we subtract 127.
+	 *  255 is a special case, since 255 - 127 = +128, which is
+	 *  interpreted as -128 in signed char format.  This is at the
+	 *  wrong end of the spectrum, so we simply eliminate this
+	 *  rogue value.  Had the designers chosen 128 as the center
+	 *  position, we would not have this issue.
+	 */
+	raw = rx->oi_analog[c];
+	if ( raw == 255 )
+	    raw = 254;
+	val = (int)raw - 127;
+
+	db = Rc_deadband[c];
+	if ( db != 0 )
+	{
+	    if ( val > db )
+		val = (val - db) * 127 / (127 - db);
+	    else if ( val < -db )
+		val = (val + db) * 127 / (127 - db);
+	    else
+		val = 0;
+	}
+
+	/* val + expo * (val^3 / 127^2 - val) / 127 */
+	if ( Rc_expo[c] != 0 )
+	{
+	    cube = (long)val * val * val / (127L * 127L);
+	    val += (int)((long)Rc_expo[c] * (cube - val) / 127);
+	}
+	Rc_snapshot.channel[c] = val;
+    }
+}
+
 /** @} */
 
 
@@ -341,7 +487,8 @@ void    controller_begin_autonomous_mode(void)
  *  (except interrupt handlers) can execute.  Generally, this should only
  *  be done if the next statement after controller_submit_data() should
  *  not be executed until the master processor has received the current
- *  command.
+ *  command.  The RC data in the packet that comes back is left for
+ *  rc_new_data_available() to report as usual.
  *
  *  If NO_WAIT, controller_submit_data() returns immediately, and the data
  *  will be picked up by the master processor at an unknown time within
@@ -376,6 +523,8 @@ void    controller_begin_autonomous_mode(void)
 void    controller_submit_data(unsigned char wait)
 
 {
+    unsigned char   rx_done;
+
     /* Only do this if the ISR has sent the previous copy */
     /* On second thought, is this a good idea?  This will prevent
        old, unsent data from being replaced by newer data. Hence,
@@ -387,6 +536,9 @@ void    controller_submit_data(unsigned char wait)
 	if (User_txdata.current_mode == 2)
 	    check_tx_env();
 
+	/* Once per frame is plenty for stack high-water marks */
+	mem_monitor_check();
+
 	/* 
 	 *  Clear bit 7 for what reason I do not know.  Doesn't actually
 	 *  seem to matter, but it's in the default code.
@@ -398,6 +550,10 @@ void    controller_submit_data(unsigned char wait)
 	 */
 	memcpy(Tx_buff + Tx_user_buff_index,&User_txdata,sizeof(tx_data_t));
 	
+	/* Slew limits apply to the copy, so pwm_read() sees the request */
+	if ( Pwm_output_mask )
+	    pwm_output_apply(Tx_buff[Tx_user_buff_index].pwm);
+	
 	/*
 	 *  Toggle double buffers and indicate new data is ready.
 	 *  Make sure the following is not interrupted by the SPI ISR,
@@ -406,15 +562,29 @@ void    controller_submit_data(unsigned char wait)
 	PIE1bits.SSPIE = 0;
 	Tx_user_buff_index = !Tx_user_buff_index;
 	Spi_status.new_tx_data = 1;
+	/*
+	 *  The first packet to start from here on carries this data.  If
+	 *  one is already on its way, that one ends first.  With SSPIE
+	 *  off, no packet can end between these reads.  INT0 can start
+	 *  one, but only after receiving is read, and it sends this data.
+	 */
+	rx_done = Spi_status.receiving;
+	rx_done += Spi_rx_packets + 1;
+	if ( Latency_enabled )
+	    latency_user_submitted();
 	PIE1bits.SSPIE = 1;
 	
 	/* Tell master this is a new packet? */
 	User_txdata.packet_num++;
     }
     
-    /* Wait for master to receive new data */
+    /*
+     *  Wait for master to receive new data.  This watches the SPI ISR
+     *  directly rather than using rc_new_data_available(), which
+     *  belongs to the frame callback when there is one.
+     */
     if ( wait == WAIT )
-	while ( !rc_new_data_available() )
+	while ( Spi_rx_packets != rx_done )
 	    ;
 }
 
@@ -427,8 +597,8 @@ void    controller_submit_data(unsigned char wait)
 void    controller_print_version(void)
 
 {
-    printf("\nVEX master code v%d\n%s\n",
-	(int)User_rxdata->master_version, CODE_VERSION);
+    ov_printf("\nVEX master code v%d\n", (int)User_rxdata->master_version);
+    ov_puts(CODE_VERSION);
 }
 
 /** @} */
@@ -482,7 +652,7 @@ void    controller_print_version(void)
  *  Dec 2008     J Bacon
  */
 
-signed char    pwm_write(unsigned char port,signed char val)
+OV_INLINE signed char  pwm_write(unsigned char port,signed char val)
 {
     /*
      *  Master processor treats 127 as stop/center, so we add 127 to
@@ -499,6 +669,9 @@ signed char    pwm_write(unsigned char port,signed char val)
     if ( VALID_PWM_PORT(port) )
     {
 	User_txdata.pwm[port-1] = val + 127;
+	/* Ports generated locally change at the next pulse */
+	if ( Pwm_user_mask & (1 << (port-1)) )
+	    pwm_user_write(port, pwm_output_map(port, val));
 	return OV_OK;
     }
     else
@@ -532,69 +705,105 @@ signed char    pwm_read(unsigned char port)
 }
 
 
-/*
- *  Designate which controller will control the specified PWM port.
- *  Valid arguments are PWM_MASTER and PWM_USER.  Currently, only
- *  PWM_MASTER is supported.  Changes made through this function
- *  will not take effect until controller_submit_data() is called.
+/**
+ *  Designate which controller will generate the pulses for the
+ *  specified PWM port.  Valid arguments are PWM_MASTER (the default)
+ *  and PWM_USER.  The master processor will not stop or start driving
+ *  the port until controller_submit_data() is called.
+ *
+ *  PWM_USER is available for ports 1 to 4 only, which the user
+ *  processor drives from CCP2-CCP5 using Timer3.  pwm_write() on
+ *  these ports takes effect at the next pulse, rather than waiting
+ *  for controller_submit_data() and the next SPI packet, which makes
+ *  them suitable for fast control loops.  See pwm_user_set_period().
+ *  Reversal and linearization still apply to them, but slew limits
+ *  and braking do not.
+ *
+ *  \param  port        PWM OUT port, 1 to 8.
+ *  \param  controller  PWM_MASTER or PWM_USER.
+ *
+ *  \returns    OV_OK on success, OV_BAD_PARAM for an invalid port,
+ *              or if the port cannot be driven by the user processor.
+ *              See pwm_user_enable().
  */
 
 /*
  * History:
  *  Dec 2008     J Bacon
+ *  Oct 2026     J Bacon     Implement PWM_USER on ports 1-4
  */
 
-void    pwm_select_processor(unsigned char port,
+status_t    pwm_select_processor(unsigned char port,
 	    pwm_controller_t controller)
 {
+    if ( ! VALID_PWM_PORT(port) )
+	return OV_BAD_PARAM;
+
     switch(controller)
     {
 	case    PWM_MASTER:
+	    pwm_user_disable(port);
 	    User_txdata.pwm_mask |= (1 << ((port)-1));
 	    break;
 	case    PWM_USER:
+	    if ( pwm_user_enable(port) != OV_OK )
+		return OV_BAD_PARAM;
+	    pwm_user_write(port,
+		pwm_output_map(port, User_txdata.pwm[port-1] - 127));
 	    User_txdata.pwm_mask &= ~(1 << ((port)-1));
 	    break;
+	default:
+	    return OV_BAD_PARAM;
     }
+    return OV_OK;
 }
 
 
 /*
  *  Select output mode for CCP ports (motor ports 1-4).  Valid arguments
  *  for each port are IFI_PWM for standard PWM output and USER_CCP
- *  to use the port for digital I/O or CCP.  Currently, only IFI_PWM
- *  is supported.
+ *  to use the port for digital I/O or CCP.  IFI_PWM ports can be
+ *  generated by either processor (see pwm_select_processor()).
+ *  USER_CCP ports are left entirely to the user code, so this stops
+ *  any library pulse generation on them.
  */
 
 /*
  * History: 
  *  Dec 2008    J Bacon     Derived from Vex default code.
+ *  Oct 2026    J Bacon     Leave CCPs generating PWM_USER pulses alone
  */
 
 void    pwm_set_output_type(int pwmSpec1, int pwmSpec2, int pwmSpec3, int pwmSpec4)
 
 {
+    unsigned char   port;
+    
     Pwm_disable_mask = 0;
 
     if (pwmSpec1 == USER_CCP)
 	Pwm_disable_mask |= 0x01;
-    else
+    else if ( ! (Pwm_user_mask & 0x01) )
 	CCP2CON = 0;
 
     if (pwmSpec2 == USER_CCP)
 	Pwm_disable_mask |= 0x02;
-    else
+    else if ( ! (Pwm_user_mask & 0x02) )
 	CCP3CON = 0;
 
     if (pwmSpec3 == USER_CCP)
 	Pwm_disable_mask |= 0x04;
-    else
+    else if ( ! (Pwm_user_mask & 0x04) )
 	CCP4CON = 0;
 
     if (pwmSpec4 == USER_CCP)
 	Pwm_disable_mask |= 0x08;
-    else
+    else if ( ! (Pwm_user_mask & 0x08) )
 	CCP5CON = 0;
+
+    for (port = 1; port <= PWM_USER_PORTS; ++port)
+	if ( Pwm_disable_mask & (1 << (port-1)) )
+	    pwm_user_disable(port);
 }
 
 /** @} */
@@ -26,6 +26,14 @@
 #ifndef __master_h__
 #define __master_h__
 
+#ifndef __general_h__
+#include "general.h"
+#endif
+
+#ifndef __platform_h__
+#include "platform.h"
+#endif
+
 #define NO_WAIT 0
 #define WAIT    1
 
@@ -76,15 +84,35 @@ typedef enum
     PWM_MASTER
 }   pwm_controller_t;
 
+/*
+ *  RC channel values decoded by rc_new_data_available() when it returns
+ *  TRUE, and left alone otherwise.  See rc_read_data().
+ */
+typedef struct
+{
+    signed char     channel[TOTAL_RC_CHANNELS];
+}   rc_snapshot_t;
+
+extern rc_snapshot_t    Rc_snapshot;
+
+/**
+ *  Unchecked rc_read_data() for use where channel is known to be valid,
+ *  such as with a constant.
+ */
+
+#define RC_READ_DATA(ch)        (Rc_snapshot.channel[(ch)-1])
+
 /* master.c */
 unsigned char rc_read_status(void);
 signed char rc_read_data(unsigned char channel);
+status_t rc_set_deadband(unsigned char channel, unsigned char deadband);
+status_t rc_set_expo(unsigned char channel, unsigned char expo);
 unsigned char controller_in_autonomous_mode(void);
 unsigned char rc_new_data_available(void);
-signed char rc_button_sequence(unsigned char, unsigned char);
+void rc_set_frame_callback(void (*callback)(void));
 signed char pwm_write(unsigned char port, signed char val);
 signed char pwm_read(unsigned char port);
-void pwm_select_processor(unsigned char port, pwm_controller_t controller);
+status_t pwm_select_processor(unsigned char port, pwm_controller_t controller);
 void pwm_set_output_type(int pwmSpec1, int pwmSpec2, int pwmSpec3, int pwmSpec4);
 void controller_submit_data(unsigned char wait);
 void master_set_user_cmd(unsigned char cmd);
@@ -93,5 +121,8 @@ void controller_begin_autonomous_mode(void);
 void controller_end_autonomous_mode(void);
 void controller_print_version(void);
 
+/* rc_button.c */
+signed char rc_button_sequence(unsigned char, unsigned char);
+
 #endif
 
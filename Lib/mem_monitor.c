@@ -0,0 +1,239 @@
+/**************************************************************************
+*
+*   Software stack and return stack high-water monitoring.
+*
+*   The unused part of the software stack is painted with a marker at
+*   boot, and the marker is checked a little at a time as the stack
+*   grows, so watching it costs almost nothing once the program has
+*   settled.  The hardware return stack depth (STKPTR) is sampled by
+*   the low priority ISR, which catches the main program at random
+*   points, and by each check.
+*
+***************************************************************************
+*
+*   This code is free software: you can redistribute it and/or modify
+*   it under the terms of the GNU General Public License as published by
+*   the Free Software Foundation, either version 3 of the License, or
+*   (at your option) any later version.
+*
+*   This code is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License
+*   along with this code.  If not, see <http://www.gnu.org/licenses/>.
+*
+***************************************************************************/
+
+#include <string.h>
+#include "platform.h"
+#include "reset_diag.h"
+#include "mem_monitor.h"
+#include "ov_printf.h"
+
+#define MEM_STACK       ((unsigned long DATA *)STACK_BASE)
+
+/*
+ *  MEM_STACK_FAR(i) is the ith longword from the end of the stack
+ *  that is used last.
+ */
+#ifdef __SDCC
+/* Grows down from the top of the page.  FSR1 is the next free byte. */
+#define MEM_STACK_FREE()    (FSR1L)
+#define MEM_STACK_FAR(i)    (MEM_STACK[(i)])
+#else
+/* Grows up from STACK_BASE.  FSR1 is the next free byte. */
+#define MEM_STACK_FREE()    (STACK_SIZE - FSR1L)
+#define MEM_STACK_FAR(i)    (MEM_STACK[MEM_STACK_LONGS - 1 - (i)])
+#endif
+
+volatile unsigned char  Mem_stkptr_max;
+
+static unsigned char    Mem_stack_painted;
+static unsigned char    Mem_stack_unused;   /* Longwords never touched */
+static unsigned char    Mem_faults;
+static void             (*Mem_fault_handler)(unsigned char fault);
+
+static void mem_monitor_fault(unsigned char fault);
+
+/**
+ *  \defgroup mem_monitor Memory Monitor
+ *  @{
+ *
+ *  These functions report how deep the software stack and the
+ *  hardware return stack have been, and call a fault handler if
+ *  either overflows.  controller_init() paints the stack and
+ *  controller_submit_data() checks it once per frame, so a program
+ *  need only call mem_monitor_print() or mem_monitor_read() to see
+ *  the results.
+ */
+
+/**
+ *  Paint all unused software stack space with MEM_PAINT and reset the
+ *  high-water marks.  Called by controller_init().  Space in use by
+ *  the caller is not painted, so calling this from deeper in the call
+ *  tree makes the stack report less accurate.
+ */
+
+/*
+ * History:
+ *  Oct 2026    J Bacon
+ */
+
+void    mem_monitor_init(void)
+
+{
+    unsigned char   c;
+    int             free = MEM_STACK_FREE() - MEM_PAINT_MARGIN;
+
+    Mem_stack_painted = free > 0 ? free / sizeof(long) : 0;
+    for (c = 0; c < Mem_stack_painted; ++c)
+	MEM_STACK_FAR(c) = MEM_PAINT;
+    Mem_stack_unused = Mem_stack_painted;
+    Mem_stkptr_max = STKPTR & MEM_STKPTR_MASK;
+    Mem_faults = 0;
+}
+
+
+/**
+ *  Update the high-water marks and check for overflows.  This
+ *  compares at most STACK_SIZE / 4 markers, few enough to do every
+ *  frame.  It is called once per frame by controller_submit_data(),
+ *  but may be called more often.
+ *
+ *  The first time each kind of overflow is seen, the fault handler is
+ *  called with the MEM_FAULT_* flag.  See
+ *  mem_monitor_set_fault_handler().
+ */
+
+/*
+ * History:
+ *  Oct 2026    J Bacon
+ */
+
+void    mem_monitor_check(void)
+
+{
+    unsigned char   faults = 0,
+		    c;
+
+    /* The ISR may raise it between the test and the store.  Harmless. */
+    MEM_MONITOR_ISR();
+
+    /*
+     *  Scan from the far end to the first overwritten marker.  A
+     *  frame can skip over markers, e.g. a local array that is never
+     *  filled, so an intact marker says nothing about those nearer
+     *  the top.  Markers past Mem_stack_unused are already known to
+     *  be overwritten.
+     */
+    for (c = 0; (c < Mem_stack_unused) && (MEM_STACK_FAR(c) == MEM_PAINT);
+	    ++c)
+	;
+    Mem_stack_unused = c;
+
+    /* Even the far end has been written, so it probably went past */
+    if ( (Mem_stack_painted != 0) && (MEM_STACK_FAR(0) != MEM_PAINT) )
+	faults |= MEM_FAULT_STACK;
+
+    /* Only seen if STVREN is off, otherwise the PIC resets instead */
+    if ( STKPTR & MEM_STKPTR_STKFUL )
+	faults |= MEM_FAULT_RETURN_STACK;
+
+    faults &= ~Mem_faults;
+    if ( faults != 0 )
+    {
+	Mem_faults |= faults;
+	if ( Mem_fault_handler != NULL )
+	    Mem_fault_handler(faults);
+	else
+	    mem_monitor_fault(faults);
+    }
+}
+
+
+/**
+ *  Copy the current high-water marks.
+ *
+ *  \param  usage   Address of structure to receive them.
+ */
+
+/*
+ * History:
+ *  Oct 2026    J Bacon
+ */
+
+void    mem_monitor_read(mem_usage_t *usage)
+
+{
+    usage->stack_used = STACK_SIZE - Mem_stack_unused * sizeof(long);
+    usage->stack_size = STACK_SIZE;
+    usage->return_stack_used = Mem_stkptr_max;
+    usage->faults = Mem_faults;
+}
+
+
+/**
+ *  Choose what happens when a stack overflows.  By default, the
+ *  overflow is recorded with reset_diag_log() and the controller is
+ *  reset, since RAM beyond the stack may have been overwritten.
+ *  After the reset, reset_diag_print() shows a RESET_DIAG_MEM_FAULT
+ *  record followed by a reset by instruction.
+ *
+ *  \param  handler Function to call with the MEM_FAULT_* flags, or
+ *                  NULL for the default.  If it returns, the program
+ *                  continues and the same fault is not reported again.
+ */
+
+/*
+ * History:
+ *  Oct 2026    J Bacon
+ */
+
+void    mem_monitor_set_fault_handler(void (*handler)(unsigned char fault))
+
+{
+    Mem_fault_handler = handler;
+}
+
+
+/**
+ *  Print the high-water marks on one line to the serial port.  This is
+ *  meant to be added to a program's periodic status output.
+ */
+
+/*
+ * History:
+ *  Oct 2026    J Bacon
+ */
+
+void    mem_monitor_print(void)
+
+{
+    mem_usage_t usage;
+
+    mem_monitor_read(&usage);
+    ov_printf("Mem: stack %u/%u return stack %d/%d faults %x\n",
+	usage.stack_used, usage.stack_size,
+	usage.return_stack_used, MEM_RETURN_STACK_LEVELS, usage.faults);
+}
+
+/** @} */
+
+
+/*
+ *  Default fault handler.
+ *
+ * History:
+ *  Oct 2026    J Bacon
+ */
+
+static void mem_monitor_fault(unsigned char fault)
+
+{
+    reset_diag_log(RESET_DIAG_MEM_FAULT, fault);
+    _ASM
+    reset
+    _ENDASM;
+}
@@ -0,0 +1,74 @@
+/**************************************************************************
+* Description:
+*   Software stack and return stack high-water monitoring.
+*
+***************************************************************************
+*
+*   This code is free software: you can redistribute it and/or modify
+*   it under the terms of the GNU General Public License as published by
+*   the Free Software Foundation, either version 3 of the License, or
+*   (at your option) any later version.
+*
+*   This code is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License
+*   along with this code.  If not, see <http://www.gnu.org/licenses/>.
+*
+***************************************************************************/
+
+#ifndef __mem_monitor_h__
+#define __mem_monitor_h__
+
+#ifndef __platform_h__
+#include "platform.h"
+#endif
+
+/* Painted into unused stack.  See debug_stack_paint() for why 4 bytes. */
+#define MEM_PAINT               0xdeadbeef
+#define MEM_STACK_LONGS         (STACK_SIZE / sizeof(long))
+
+/* Bytes left unpainted at boot for mem_monitor_init() and its callers */
+#define MEM_PAINT_MARGIN        8
+
+/* Hardware return stack: 31 levels, depth in STKPTR bits 0-4 */
+#define MEM_STKPTR_MASK         0x1f
+#define MEM_STKPTR_STKFUL       0x80
+#define MEM_RETURN_STACK_LEVELS 31
+
+/* Faults passed to the fault handler */
+#define MEM_FAULT_STACK         0x01    /* Software stack overflowed */
+#define MEM_FAULT_RETURN_STACK  0x02    /* Return stack overflowed */
+
+typedef struct
+{
+    unsigned short  stack_used;         /* High water, bytes */
+    unsigned short  stack_size;         /* STACK_SIZE */
+    unsigned char   return_stack_used;  /* High water, levels */
+    unsigned char   faults;             /* MEM_FAULT_* seen so far */
+}   mem_usage_t;
+
+/* Sampled by the low priority ISR */
+extern volatile unsigned char   Mem_stkptr_max;
+
+/*
+ *  Record the return stack depth at the deepest point the main
+ *  program has reached when an interrupt arrives.  Used by
+ *  InterruptHandlerLow().
+ */
+#define MEM_MONITOR_ISR() \
+    { \
+	if ( (STKPTR & MEM_STKPTR_MASK) > Mem_stkptr_max ) \
+	    Mem_stkptr_max = STKPTR & MEM_STKPTR_MASK; \
+    }
+
+/* mem_monitor.c */
+void mem_monitor_init(void);
+void mem_monitor_check(void);
+void mem_monitor_read(mem_usage_t *usage);
+void mem_monitor_set_fault_handler(void (*handler)(unsigned char fault));
+void mem_monitor_print(void);
+
+#endif
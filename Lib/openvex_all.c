@@ -0,0 +1,72 @@
+/**************************************************************************
+* Description:
+*   The whole library as one translation unit, for UNITY_BUILD=yes.
+*   See Include/Makefile.sdcc_defs.
+*
+*   SDCC optimizes one source file at a time, so a small library
+*   function called from another file always costs a full call, with
+*   its arguments passed on the software stack.  Compiled together,
+*   the functions marked OV_INLINE can be expanded in place by their
+*   callers in the rest of the library.  Each remains an ordinary
+*   external function for programs that call it.
+*
+*   The price is that the linker can no longer leave out the parts of
+*   the library a program does not use, since it is all one object.
+*   Whether that is a good trade depends on the program, so compare
+*   both builds with "make unity-compare" before choosing.
+*
+*   A function is only inlined where it is called below its definition,
+*   so the files defining OV_INLINE functions come first.
+*
+***************************************************************************
+*
+*   This code is free software: you can redistribute it and/or modify
+*   it under the terms of the GNU General Public License as published by
+*   the Free Software Foundation, either version 3 of the License, or
+*   (at your option) any later version.
+*
+*   This code is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License
+*   along with this code.  If not, see <http://www.gnu.org/licenses/>.
+*
+***************************************************************************/
+
+#define OV_INLINE   inline
+
+/* Define OV_INLINE functions first */
+#include "io.c"
+#include "io_digital.c"
+#include "master.c"
+#include "shaft_encoder.c"
+
+#include "io_digital_mask.c"
+#include "timer.c"
+#include "timer_simple.c"
+#include "vex_delay.c"
+#include "interrupts.c"
+#include "vex_spi.c"
+#include "vex_usart.c"
+#include "init.c"
+#include "sonar.c"
+#include "debug.c"
+#include "lvd.c"
+#include "arcade_drive.c"
+#include "accelerometer.c"
+#include "line_sensor.c"
+#include "link_stats.c"
+#include "latency.c"
+#include "input_event.c"
+#include "pwm_user.c"
+#include "pwm_output.c"
+#include "debounce.c"
+#include "robot_config.c"
+#include "adc_scan.c"
+#include "reset_diag.c"
+#include "mem_monitor.c"
+#include "shaft_tps.c"
+#include "rc_button.c"
+#include "ov_printf.c"
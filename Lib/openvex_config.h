@@ -0,0 +1,95 @@
+/**************************************************************************
+* Description:
+*   Build-time selection of library subsystems.
+*
+*   Each subsystem left out is also left out of InterruptHandlerLow(),
+*   which makes every low priority interrupt shorter, and its enable
+*   function returns OV_BAD_PARAM so that a program relying on it finds
+*   out at once.  Everything is enabled by default.  To leave something
+*   out, either change the default below or add e.g.
+*
+*       CFLAGS += -DOV_USE_SONAR=0 -DOV_USE_TIMER4=0
+*
+*   to Include/Makefile.sdcc_defs (-d instead of -D for MCC18), then
+*   rebuild the library with "make realclean all".  The library is
+*   shared by every program built against it.
+*
+***************************************************************************
+*
+*   This code is free software: you can redistribute it and/or modify
+*   it under the terms of the GNU General Public License as published by
+*   the Free Software Foundation, either version 3 of the License, or
+*   (at your option) any later version.
+*
+*   This code is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License
+*   along with this code.  If not, see <http://www.gnu.org/licenses/>.
+*
+***************************************************************************/
+
+#ifndef __openvex_config_h__
+#define __openvex_config_h__
+
+/* Interrupt driven sonar: sonar_init() and sonar_read() */
+#ifndef OV_USE_SONAR
+#define OV_USE_SONAR            1
+#endif
+
+/* Standard shaft encoders: shaft_encoder_enable_std() */
+#ifndef OV_USE_ENCODER_STD
+#define OV_USE_ENCODER_STD      1
+#endif
+
+/* Quadrature shaft encoders: shaft_encoder_enable_quad() */
+#ifndef OV_USE_ENCODER_QUAD
+#define OV_USE_ENCODER_QUAD     1
+#endif
+
+/*
+ *  Timers 1 to 4 for timer_start() and timer_allocate().  Timer0 is
+ *  the system timer and is always used.  The subsystems below use
+ *  Timers 2 to 4 directly and keep their interrupts even if the
+ *  timer is not available to the program.
+ */
+#ifndef OV_USE_TIMER1
+#define OV_USE_TIMER1           1
+#endif
+#ifndef OV_USE_TIMER2
+#define OV_USE_TIMER2           1
+#endif
+#ifndef OV_USE_TIMER3
+#define OV_USE_TIMER3           1
+#endif
+#ifndef OV_USE_TIMER4
+#define OV_USE_TIMER4           1
+#endif
+
+/* Background analog sampling on Timer2: adc_scan_enable(), adc_watch() */
+#ifndef OV_USE_ADC_SCAN
+#define OV_USE_ADC_SCAN         1
+#endif
+
+/* Servo pulses on Timer3: pwm_user_enable() */
+#ifndef OV_USE_PWM_USER
+#define OV_USE_PWM_USER         1
+#endif
+
+/* Debounced inputs on Timer4: debounce_watch() */
+#ifndef OV_USE_DEBOUNCE
+#define OV_USE_DEBOUNCE         1
+#endif
+
+/* Per-frame callback: rc_set_frame_callback() */
+#ifndef OV_USE_FRAME_CALLBACK
+#define OV_USE_FRAME_CALLBACK   1
+#endif
+
+/* Derived: anything that takes interrupts on interrupt ports 1 to 6 */
+#define OV_USE_INTERRUPT_PORTS \
+    (OV_USE_SONAR || OV_USE_ENCODER_STD || OV_USE_ENCODER_QUAD)
+
+#endif
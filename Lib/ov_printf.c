@@ -0,0 +1,295 @@
+/**************************************************************************
+*
+*   Compact integer-only formatted output to the serial port.
+*
+*   The compilers' printf() is a general formatter, with floating point
+*   and a long division per decimal digit, and it reaches the USART
+*   through a chain of stream functions.  Everything the library and
+*   the example programs print is integers, hex and strings, which
+*   ov_printf() handles in a fraction of the code.  Decimal digits are
+*   found by subtracting powers of ten, so no division routines are
+*   linked in at all.  A program that uses only ov_printf() and
+*   DPRINTF() leaves printf() out entirely.  Bin/size-report shows the
+*   difference.
+*
+***************************************************************************
+*
+*   This code is free software: you can redistribute it and/or modify
+*   it under the terms of the GNU General Public License as published by
+*   the Free Software Foundation, either version 3 of the License, or
+*   (at your option) any later version.
+*
+*   This code is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License
+*   along with this code.  If not, see <http://www.gnu.org/licenses/>.
+*
+***************************************************************************/
+
+#include <stdarg.h>
+#include "platform.h"
+#include "vex_usart.h"
+#include "ov_printf.h"
+
+static const ROM unsigned long  Ov_powers[OV_PRINTF_DIGITS] =
+{
+    1000000000, 100000000, 10000000, 1000000, 100000,
+    10000, 1000, 100, 10, 1
+};
+
+/* Ov_powers[OV_SHORT_DIGITS] is the first needed for a 16-bit value */
+#define OV_SHORT_DIGITS     5
+
+static const ROM char   Ov_hex_digits[] = "0123456789abcdef";
+
+static unsigned char ov_decimal(char *buff, unsigned long val);
+static void ov_pad(char ch, unsigned char count);
+
+/**
+ *  \defgroup ov_printf Formatted Output
+ *  @{
+ *
+ *  These functions write to the serial port opened by controller_init(),
+ *  waiting for the USART as each character goes out, like printf().
+ *  DPRINTF() uses ov_printf().
+ *
+ *  \code
+ *  ov_printf("ET: %ld  RC: %4d  Line: %02x\n", elapsed, rc_read_data(1),
+ *      line);
+ *  \endcode
+ */
+
+/**
+ *  Write one character to the serial port.
+ *
+ *  \param  ch  Character to write.  No newline translation is done.
+ */
+
+/*
+ * History:
+ *  Oct 2026    J Bacon
+ */
+
+void    ov_putc(char ch)
+
+{
+    while ( ! USART_READY )
+	;
+    TXREG1 = ch;
+}
+
+
+/**
+ *  Write a string and a newline to the serial port, like puts().
+ *
+ *  \param  str Null-terminated string.
+ */
+
+/*
+ * History:
+ *  Oct 2026    J Bacon
+ */
+
+void    ov_puts(OV_STRING *str)
+
+{
+    while ( *str != '\0' )
+	ov_putc(*str++);
+    ov_putc('\n');
+}
+
+
+/**
+ *  Write formatted output to the serial port.  This is a subset of
+ *  printf():
+ *
+ *      %d %i %u %x %X  int, or long with l, e.g. %ld.  Hex is lower case.
+ *      %c %s %%        char, RAM string, percent sign
+ *
+ *  Each may have a minimum field width, padded with blanks on the left,
+ *  with zeros if the width starts with 0, e.g. %04x, or with blanks on
+ *  the right after a -, e.g. %-6d.  Anything else, such as %f, is
+ *  printed as the conversion character.  As with printf(), do not cast
+ *  char arguments to char, which makes SDCC pass them as a single byte.
+ *
+ *  \param  format  Format string, usually a literal.
+ */
+
+/*
+ * History:
+ *  Oct 2026    J Bacon
+ */
+
+void    ov_printf(OV_STRING *format, ...)
+
+{
+    va_list         ap;
+    char            buff[OV_PRINTF_DIGITS],
+		    ch,
+		    pad,
+		    *p;
+    unsigned char   width,
+		    fill,
+		    is_long,
+		    left,
+		    neg;
+    unsigned short  len;
+    unsigned long   val;
+    long            sval;
+
+    va_start(ap, format);
+    while ( (ch = *format++) != '\0' )
+    {
+	if ( ch != '%' )
+	{
+	    ov_putc(ch);
+	    continue;
+	}
+
+	/* Flags, width and size */
+	pad = ' ';
+	left = neg = is_long = 0;
+	width = 0;
+	ch = *format++;
+	if ( ch == '-' )
+	{
+	    left = 1;
+	    ch = *format++;
+	}
+	if ( ch == '0' )
+	{
+	    pad = '0';
+	    ch = *format++;
+	}
+	while ( (ch >= '0') && (ch <= '9') )
+	{
+	    width = width * 10 + ch - '0';
+	    ch = *format++;
+	}
+	if ( ch == 'l' )
+	{
+	    is_long = 1;
+	    ch = *format++;
+	}
+
+	p = buff;
+	switch(ch)
+	{
+	    case    '\0':
+		va_end(ap);
+		return;
+	    case    'd':
+	    case    'i':
+		sval = is_long ? va_arg(ap, long) : va_arg(ap, int);
+		if ( sval < 0 )
+		{
+		    neg = 1;
+		    val = 0 - (unsigned long)sval;
+		}
+		else
+		    val = sval;
+		len = ov_decimal(buff, val);
+		break;
+	    case    'u':
+		val = is_long ? va_arg(ap, unsigned long) :
+		    va_arg(ap, unsigned int);
+		len = ov_decimal(buff, val);
+		break;
+	    case    'x':
+	    case    'X':
+		val = is_long ? va_arg(ap, unsigned long) :
+		    va_arg(ap, unsigned int);
+		/* Least significant digit first, from the end of buff */
+		p = buff + sizeof(buff);
+		len = 0;
+		do
+		{
+		    *--p = Ov_hex_digits[(unsigned char)val & 0x0f];
+		    val >>= 4;
+		    ++len;
+		}   while ( val != 0 );
+		break;
+	    case    'c':
+		buff[0] = va_arg(ap, int);
+		len = 1;
+		break;
+	    case    's':
+		p = va_arg(ap, char *);
+		for (len = 0; p[len] != '\0'; ++len)
+		    ;
+		break;
+	    default:
+		buff[0] = ch;
+		len = 1;
+		break;
+	}
+
+	/* The sign counts toward the width and goes before zero padding */
+	fill = (width > len + neg) ? width - len - neg : 0;
+	if ( ! left && (pad == ' ') )
+	    ov_pad(' ', fill);
+	if ( neg )
+	    ov_putc('-');
+	if ( ! left && (pad == '0') )
+	    ov_pad('0', fill);
+	while ( len-- != 0 )
+	    ov_putc(*p++);
+	if ( left )
+	    ov_pad(' ', fill);
+    }
+    va_end(ap);
+}
+
+/** @} */
+
+
+/*
+ *  Write the decimal digits of val to buff, without leading zeros.
+ *  Returns the number of digits.  Each digit is found by subtracting
+ *  its power of ten, at most 9 times, which is much faster on the PIC
+ *  than a 32-bit division per digit.
+ *
+ * History:
+ *  Oct 2026    J Bacon
+ */
+
+static unsigned char    ov_decimal(char *buff, unsigned long val)
+
+{
+    unsigned char   c,
+		    len = 0;
+    unsigned long   power;
+    char            digit;
+
+    /* Skip the powers that cannot divide a 16-bit value */
+    c = (val > 0xffff) ? 0 : OV_SHORT_DIGITS;
+    for (; c < OV_PRINTF_DIGITS; ++c)
+    {
+	power = Ov_powers[c];
+	digit = '0';
+	while ( val >= power )
+	{
+	    val -= power;
+	    ++digit;
+	}
+	if ( (len != 0) || (digit != '0') || (c == OV_PRINTF_DIGITS - 1) )
+	    buff[len++] = digit;
+    }
+    return len;
+}
+
+
+/*
+ * History:
+ *  Oct 2026    J Bacon
+ */
+
+static void ov_pad(char ch, unsigned char count)
+
+{
+    while ( count-- != 0 )
+	ov_putc(ch);
+}
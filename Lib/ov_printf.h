@@ -0,0 +1,48 @@
+/**************************************************************************
+* Description:
+*   Compact integer-only formatted output to the serial port.
+*
+***************************************************************************
+*
+*   This code is free software: you can redistribute it and/or modify
+*   it under the terms of the GNU General Public License as published by
+*   the Free Software Foundation, either version 3 of the License, or
+*   (at your option) any later version.
+*
+*   This code is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License
+*   along with this code.  If not, see <http://www.gnu.org/licenses/>.
+*
+***************************************************************************/
+
+#ifndef __ov_printf_h__
+#define __ov_printf_h__
+
+#ifndef __platform_h__
+#include "platform.h"
+#endif
+
+/*
+ *  Format strings and ov_puts() strings.  Under SDCC this is a generic
+ *  pointer, which reaches literals in program memory and buffers in
+ *  RAM alike.  MCC18 keeps literals in program memory.
+ */
+#ifdef __SDCC
+#define OV_STRING   const char
+#else
+#define OV_STRING   const rom char
+#endif
+
+/* Longest conversion: 10 decimal digits of an unsigned long */
+#define OV_PRINTF_DIGITS    10
+
+/* ov_printf.c */
+void ov_putc(char ch);
+void ov_puts(OV_STRING *str);
+void ov_printf(OV_STRING *format, ...);
+
+#endif
@@ -10,6 +10,8 @@
 // For older SDCC (2.9.0)
 #define __SDCC SDCC
 
+#include "ram_layout.h"
+
 #if defined(__SDCC)   /* SDCC specifics */
 
 #include <pic18fregs.h>
@@ -21,8 +23,16 @@
 #define NAKED_INTERRUPT     __naked __interrupt
 #define FORMAT_CAST
 #define DATA                __data
-/* Make sure this matches compiler and linker script settings! */
-#define STACK_BASE          (long DATA *)0x200
+#define ROM                 __code
+#define NEAR                /* Set by #pragma udata access */
+/*
+ *  Place the stack where ram_layout.h says.  SDCC does not expand
+ *  macros in #pragma stack, so the numbers are repeated here.  It only
+ *  takes effect in the file defining main().
+ */
+#pragma stack 0x200 0x100
+#define STACK_BASE          (long DATA *)SDCC_STACK_ADDR
+#define STACK_SIZE          SDCC_STACK_SIZE
 #define ADC_MASK            0x00
 #define _ASM                __asm
 #define _ENDASM             __endasm
@@ -48,8 +58,11 @@ void InterruptHandlerHigh(void);
 #define NAKED_INTERRUPT
 #define FORMAT_CAST (MEM_MODEL rom signed char*)
 #define DATA
+#define ROM                 rom
+#define NEAR                near
 /* Make sure this matches compiler and linker script settings! */
 #define STACK_BASE          (long DATA *)0x600
+#define STACK_SIZE          0x100
 
 /* See ADC_V2 ADC_#ANAs in adc.h and pconfig.h */
 #ifdef USE_OR_MASKS
@@ -70,6 +83,26 @@ void InterruptHandlerHigh(void);
 #define TOTAL_RC_CHANNELS       6
 #define TOTAL_PWM_PORTS         8
 
+/*
+ *  The top of the access bank, reserved for variables used on every
+ *  pass through the ISRs.  Access bank variables are reached without
+ *  a MOVLB, so the ISRs don't have to switch banks to get to them.
+ *  The rest of the access bank holds compiler temporaries.  Must match
+ *  the ISR_HOT section in the linker scripts, and the linker will
+ *  complain if it overflows.  To place variables there:
+ *
+ *  SDCC:   #pragma udata access ISR_HOT Edge_count
+ *          NEAR unsigned char Edge_count;
+ *
+ *  MCC18:  #pragma udata access ISR_HOT
+ *          NEAR unsigned char Edge_count;
+ *          #pragma udata
+ *
+ *  Declare them NEAR in extern declarations as well.
+ */
+#define ISR_HOT_BASE            0x38
+#define ISR_HOT_SIZE            0x28    /* Up to the end of access RAM */
+
 /**
  * \addtogroup debug
  *  @{
@@ -91,5 +124,17 @@ void InterruptHandlerHigh(void);
 #define LOW_INT_VECTOR      0x818
 #endif
 
+/*
+ *  Marks small library functions worth expanding in their callers.
+ *  Only openvex_all.c defines it as anything.  See UNITY_BUILD in
+ *  Include/Makefile.sdcc_defs.
+ */
+#ifndef OV_INLINE
+#define OV_INLINE
+#endif
+
+/* Subsystems included in the library */
+#include "openvex_config.h"
+
 #endif
 
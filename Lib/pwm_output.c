@@ -0,0 +1,355 @@
+/**************************************************************************
+*
+*   Output stage for PWM values sent to the master processor.
+*
+*   pwm_write() records what the user code asked for.  When the packet
+*   is submitted, controller_submit_data() passes the copy bound for
+*   the SPI ISR through pwm_output_apply(), which limits how fast each
+*   port may change.  This prevents the current spikes and wheel slip
+*   caused by jumping from full reverse to full forward in one frame.
+*   pwm_read() still returns the requested value.  Ports generated by
+*   the user processor (PWM_USER) change at the next pulse, so slew
+*   limits and braking do not apply to them.
+*
+*   Each port can also have a linearization table, which compensates
+*   for motors whose speed is far from proportional to the PWM value.
+*   Bin/pwm-linearize builds the table from logged speed data.
+*
+*   All state is kept in a few small arrays indexed by port, and ports
+*   without limits are skipped, so the cost is one pass over the
+*   8 ports per frame.
+*
+***************************************************************************
+*
+*   This code is free software: you can redistribute it and/or modify
+*   it under the terms of the GNU General Public License as published by
+*   the Free Software Foundation, either version 3 of the License, or
+*   (at your option) any later version.
+*
+*   This code is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License
+*   along with this code.  If not, see <http://www.gnu.org/licenses/>.
+*
+***************************************************************************/
+
+#include <string.h>
+#include "platform.h"
+#include "vex_spi.h"
+#include "pwm_user.h"
+#include "pwm_output.h"
+
+unsigned char           Pwm_output_mask = 0;
+
+static unsigned char    Pwm_brake_mask = 0;
+static unsigned char    Pwm_reverse_mask = 0;
+static unsigned char    Pwm_slew_up[TOTAL_PWM_PORTS];
+static unsigned char    Pwm_slew_down[TOTAL_PWM_PORTS];
+static signed char      Pwm_output[TOTAL_PWM_PORTS];    /* After slew limits */
+static const ROM unsigned char  *Pwm_linear[TOTAL_PWM_PORTS];
+
+static void pwm_output_update_mask(unsigned char port);
+
+/**
+ *  \addtogroup pwm
+ *  @{
+ */
+
+/**
+ *  Limit how quickly a PWM port may change.  Limits are applied each
+ *  time controller_submit_data() is called, which should normally be
+ *  once per frame (18.5ms).
+ *
+ *  \param  port    PWM port, 1 to 8.
+ *  \param  up      Maximum change per submit while moving away from 0
+ *                  (accelerating), or PWM_SLEW_NONE.
+ *  \param  down    Maximum change per submit while moving toward 0
+ *                  (slowing down), or PWM_SLEW_NONE.
+ *
+ *  \returns    OV_OK on success, OV_BAD_PARAM for an invalid port.
+ *
+ *  For example, pwm_set_slew(port, 8, PWM_SLEW_NONE) ramps from stop
+ *  to full power in 16 frames (0.3 seconds), but stops immediately.
+ *  Pass the same value for both for a symmetric ramp.
+ *
+ *  Limits do not apply to ports generated by the user processor.
+ *  See pwm_select_processor().
+ */
+
+/*
+ * History:
+ *  Oct 2026    J Bacon
+ */
+
+status_t    pwm_set_slew(unsigned char port, unsigned char up,
+			unsigned char down)
+
+{
+    if ( ! VALID_PWM_PORT(port) )
+	return OV_BAD_PARAM;
+
+    Pwm_slew_up[port-1] = up;
+    Pwm_slew_down[port-1] = down;
+    pwm_output_update_mask(port);
+    return OV_OK;
+}
+
+
+/**
+ *  Select brake-to-zero for a PWM port.  When the requested value
+ *  is 0 or has the opposite sign to the current output, the output
+ *  drops straight to 0 regardless of the slew limits, then ramps up
+ *  in the new direction using the up limit.
+ *
+ *  \param  port    PWM port, 1 to 8.
+ *  \param  brake   TRUE to enable, FALSE to disable.
+ *
+ *  \returns    OV_OK on success, OV_BAD_PARAM for an invalid port.
+ *
+ *  Like slew limits, braking does not apply to ports generated by the
+ *  user processor.  See pwm_select_processor().
+ */
+
+/*
+ * History:
+ *  Oct 2026    J Bacon
+ */
+
+status_t    pwm_set_brake(unsigned char port, unsigned char brake)
+
+{
+    if ( ! VALID_PWM_PORT(port) )
+	return OV_BAD_PARAM;
+
+    if ( brake )
+	Pwm_brake_mask |= 1 << (port-1);
+    else
+	Pwm_brake_mask &= ~(1 << (port-1));
+    pwm_output_update_mask(port);
+    return OV_OK;
+}
+
+
+/**
+ *  Select a linearization table for a PWM port.  The table maps the
+ *  magnitude of each value written, 0 to 127, to the magnitude
+ *  actually sent, keeping the sign.  Entry n should be the PWM value
+ *  that makes the motor run at n/127 of its top speed, so that
+ *  pwm_write() values, arcade_drive() and PID loops see a motor whose
+ *  speed is proportional to its input.
+ *
+ *  \param  port    PWM port, 1 to 8.
+ *  \param  table   128 entries in program memory, or NULL for none.
+ *
+ *  \returns    OV_OK on success, OV_BAD_PARAM for an invalid port.
+ *
+ *  Tables are generated from logged data with Bin/pwm-linearize:
+ *
+ *  \code
+ *  #include "drive_curve.h"
+ *  ...
+ *  pwm_set_linearization(LEFT_DRIVE_PORT, Drive_curve);
+ *  \endcode
+ *
+ *  Linearization follows the slew limits, and also applies to ports
+ *  generated by the user processor.
+ */
+
+/*
+ * History:
+ *  Oct 2026    J Bacon
+ */
+
+status_t    pwm_set_linearization(unsigned char port,
+		const ROM unsigned char *table)
+
+{
+    if ( ! VALID_PWM_PORT(port) )
+	return OV_BAD_PARAM;
+
+    Pwm_linear[port-1] = table;
+    pwm_output_update_mask(port);
+    return OV_OK;
+}
+
+
+/**
+ *  Reverse the direction of a PWM port, so that the same pwm_write()
+ *  values can be used for motors mounted facing opposite ways.
+ *
+ *  \param  port    PWM port, 1 to 8.
+ *  \param  reverse TRUE to reverse, FALSE for normal.
+ *
+ *  \returns    OV_OK on success, OV_BAD_PARAM for an invalid port.
+ *
+ *  pwm_read() still returns the value written.  Reversal follows the
+ *  slew limits and precedes linearization, and also applies to ports
+ *  generated by the user processor.
+ */
+
+/*
+ * History:
+ *  Oct 2026    J Bacon
+ */
+
+status_t    pwm_set_reverse(unsigned char port, unsigned char reverse)
+
+{
+    if ( ! VALID_PWM_PORT(port) )
+	return OV_BAD_PARAM;
+
+    if ( reverse )
+	Pwm_reverse_mask |= 1 << (port-1);
+    else
+	Pwm_reverse_mask &= ~(1 << (port-1));
+    pwm_output_update_mask(port);
+    return OV_OK;
+}
+
+
+/**
+ *  Read the PWM value most recently submitted for a port, after slew
+ *  limiting and before linearization.  For ports generated by the
+ *  user processor, which are not slew limited, this is the value
+ *  last submitted with pwm_write().
+ *
+ *  \param  port    PWM port, 1 to 8.
+ *
+ *  \returns    The output value, or OV_BAD_PARAM for an invalid port.
+ */
+
+/*
+ * History:
+ *  Oct 2026    J Bacon
+ */
+
+signed char pwm_read_output(unsigned char port)
+
+{
+    if ( ! VALID_PWM_PORT(port) )
+	return OV_BAD_PARAM;
+    if ( Pwm_output_mask & (1 << (port-1)) )
+	return Pwm_output[port-1];
+    return User_txdata.pwm[port-1] - 127;
+}
+
+/** @} */
+
+
+/*
+ *  Reverse a PWM value and map it through the port's linearization
+ *  table, as selected.  Used for ports generated by the user processor,
+ *  which bypass pwm_output_apply().
+ *
+ * History:
+ *  Oct 2026    J Bacon
+ */
+
+signed char pwm_output_map(unsigned char port, signed char val)
+
+{
+    const ROM unsigned char *table = Pwm_linear[port-1];
+
+    if ( Pwm_reverse_mask & (1 << (port-1)) )
+	val = -val;
+    if ( table == NULL )
+	return val;
+    if ( val < 0 )
+	return -(signed char)table[-val];
+    return table[val];
+}
+
+
+/*
+ *  Apply slew limits, braking, reversal and linearization to the PWM
+ *  values in a tx buffer about to be handed to the SPI ISR.  Called
+ *  by controller_submit_data() when Pwm_output_mask is not 0.
+ *  Ports generated by the user processor are skipped, since
+ *  pwm_write() has already sent them to pwm_user_write().  Their
+ *  Pwm_output[] follows the request, so pwm_read_output() reports
+ *  it and a port returned to the master ramps from there.
+ *
+ * History:
+ *  Oct 2026    J Bacon
+ */
+
+void    pwm_output_apply(volatile unsigned char *pwm)
+
+{
+    unsigned char   c,
+		    bit,
+		    rate;
+    int             target,
+		    out;
+
+    for (c = 0, bit = 1; c < TOTAL_PWM_PORTS; ++c, bit <<= 1)
+    {
+	if ( ! (Pwm_output_mask & bit) )
+	    continue;
+
+	target = (int)pwm[c] - 127;
+	if ( Pwm_user_mask & bit )
+	{
+	    Pwm_output[c] = target;
+	    continue;
+	}
+	out = Pwm_output[c];
+
+	if ( (Pwm_brake_mask & bit) &&
+	     ((target == 0) || ((target < 0) != (out < 0))) )
+	    out = 0;
+
+	/* Moving away from 0 uses the up rate */
+	if ( target > out )
+	{
+	    rate = out >= 0 ? Pwm_slew_up[c] : Pwm_slew_down[c];
+	    if ( (rate != PWM_SLEW_NONE) && (target - out > rate) )
+		target = out + rate;
+	}
+	else if ( target < out )
+	{
+	    rate = out <= 0 ? Pwm_slew_up[c] : Pwm_slew_down[c];
+	    if ( (rate != PWM_SLEW_NONE) && (out - target > rate) )
+		target = out - rate;
+	}
+
+	Pwm_output[c] = target;
+	if ( Pwm_reverse_mask & bit )
+	    target = -target;
+	if ( Pwm_linear[c] != NULL )
+	    target = target < 0 ? -(int)Pwm_linear[c][-target] :
+				  Pwm_linear[c][target];
+	pwm[c] = target + 127;
+    }
+}
+
+
+/*
+ *  Include a port in pwm_output_apply() if it has any processing
+ *  enabled.  A port that was not included starts from the value
+ *  last requested, so it doesn't ramp from 0.
+ *
+ * History:
+ *  Oct 2026    J Bacon
+ */
+
+static void pwm_output_update_mask(unsigned char port)
+
+{
+    unsigned char   bit = 1 << (port-1);
+
+    if ( (Pwm_slew_up[port-1] != PWM_SLEW_NONE) ||
+	 (Pwm_slew_down[port-1] != PWM_SLEW_NONE) ||
+	 ((Pwm_brake_mask | Pwm_reverse_mask) & bit) ||
+	 (Pwm_linear[port-1] != NULL) )
+    {
+	if ( ! (Pwm_output_mask & bit) )
+	    Pwm_output[port-1] = User_txdata.pwm[port-1] - 127;
+	Pwm_output_mask |= bit;
+    }
+    else
+	Pwm_output_mask &= ~bit;
+}
@@ -0,0 +1,48 @@
+/**************************************************************************
+* Description:
+*   Output stage for PWM values sent to the master processor.
+*
+***************************************************************************
+*
+*   This code is free software: you can redistribute it and/or modify
+*   it under the terms of the GNU General Public License as published by
+*   the Free Software Foundation, either version 3 of the License, or
+*   (at your option) any later version.
+*
+*   This code is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License
+*   along with this code.  If not, see <http://www.gnu.org/licenses/>.
+*
+***************************************************************************/
+
+#ifndef __pwm_output_h__
+#define __pwm_output_h__
+
+#ifndef __general_h__
+#include "general.h"
+#endif
+
+#ifndef __platform_h__
+#include "platform.h"
+#endif
+
+/* Slew rate meaning no limit */
+#define PWM_SLEW_NONE   0
+
+/* Ports with any output processing enabled, bit (n-1) for port n */
+extern unsigned char    Pwm_output_mask;
+
+/* pwm_output.c */
+status_t pwm_set_slew(unsigned char port, unsigned char up, unsigned char down);
+status_t pwm_set_brake(unsigned char port, unsigned char brake);
+status_t pwm_set_reverse(unsigned char port, unsigned char reverse);
+status_t pwm_set_linearization(unsigned char port, const ROM unsigned char *table);
+signed char pwm_read_output(unsigned char port);
+signed char pwm_output_map(unsigned char port, signed char val);
+void pwm_output_apply(volatile unsigned char *pwm);
+
+#endif
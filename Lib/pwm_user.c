@@ -0,0 +1,261 @@
+/**************************************************************************
+*
+*   Servo pulse generation on PWM OUT 1-4 by the user processor.
+*
+*   Normally the master processor generates all 8 PWM outputs from the
+*   values in each SPI packet, so a new motor setting waits up to a
+*   full 18.5ms frame before it is even sent.  PWM OUT 1-4 are also
+*   wired to the user processor's CCP2-CCP5 pins, so once a port is
+*   handed over with pwm_select_processor(port, PWM_USER), these
+*   functions generate the servo pulses locally and pwm_write() takes
+*   effect at the start of the next pulse.
+*
+*   Timer3 runs free at 0.1us per tick as the time base for CCP2-CCP5.
+*   At the start of each period, the low priority ISR raises each
+*   enabled pin and loads its CCPR register with the time to drop it.
+*   The CCP hardware ends the pulse, so its width is not affected by
+*   interrupt latency.
+*
+***************************************************************************
+*
+*   This code is free software: you can redistribute it and/or modify
+*   it under the terms of the GNU General Public License as published by
+*   the Free Software Foundation, either version 3 of the License, or
+*   (at your option) any later version.
+*
+*   This code is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License
+*   along with this code.  If not, see <http://www.gnu.org/licenses/>.
+*
+***************************************************************************/
+
+#include "platform.h"
+#include "io.h"
+#include "timer.h"
+#include "pwm_user.h"
+
+extern unsigned char    Timer_allocated[4];
+extern unsigned char    Pwm_disable_mask;
+
+/* Shared with the Timer3 branch of the low priority ISR */
+volatile unsigned char  Pwm_user_mask = 0;      /* Bit (n-1) for port n */
+unsigned char           Pwm_user_period = PWM_USER_DEFAULT_PERIOD;
+unsigned char           Pwm_user_count = 0;
+
+static volatile unsigned short  Pwm_user_ticks[PWM_USER_PORTS] =
+    { PWM_USER_CENTER_TICKS, PWM_USER_CENTER_TICKS,
+      PWM_USER_CENTER_TICKS, PWM_USER_CENTER_TICKS };
+
+/*
+ *  Raise one pin and set the time for the CCP to drop it.  Timer3
+ *  is read with the SPI interrupt held off, so the pulse is short only
+ *  by the few instructions between the read and the CCPxCON write.
+ */
+#define PWM_USER_PULSE(port, con, ccprl, ccprh) \
+    if ( Pwm_user_mask & (1 << ((port)-1)) ) \
+    { \
+	INTCONbits.GIE = 0; \
+	TIMER3_READ16(end); \
+	end += Pwm_user_ticks[(port)-1]; \
+	ccprl = end & 0xff; \
+	ccprh = end >> 8; \
+	con = 0; \
+	con = CCP_COMPARE_SET_CLEAR; \
+	INTCONbits.GIE = 1; \
+    }
+
+/**
+ *  \addtogroup pwm
+ *  @{
+ */
+
+/**
+ *  Start generating servo pulses for a PWM port on the user processor.
+ *  Normally called through pwm_select_processor(port, PWM_USER).
+ *
+ *  \param  port    PWM OUT port, 1 to 4.
+ *
+ *  \returns    OV_OK on success, OV_BAD_PARAM if the port has no CCP,
+ *              was set to USER_CCP with pwm_set_output_type(), or
+ *              Timer3 is already in use elsewhere.
+ *
+ *  The first port enabled claims Timer3, so it is no longer
+ *  available to timer_allocate().
+ */
+
+/*
+ * History:
+ *  Oct 2026    J Bacon
+ */
+
+status_t    pwm_user_enable(unsigned char port)
+
+{
+    if ( ! OV_USE_PWM_USER || ! VALID_PWM_USER_PORT(port) ||
+	 (Pwm_disable_mask & (1 << (port-1))) )
+	return OV_BAD_PARAM;
+
+    if ( Pwm_user_mask == 0 )
+    {
+	if ( Timer_allocated[2] )
+	    return OV_BAD_PARAM;
+	Timer_allocated[2] = TIMER_LIBRARY;
+	Pwm_user_count = 0;
+	TIMER3_DISABLE_INTERRUPTS();
+	T3CON = PWM_USER_T3CON;
+	TIMER3_CLEAR_INTERRUPT_FLAG();
+	TIMER3_ENABLE_INTERRUPTS();
+    }
+
+    /* The pin idles low between pulses */
+    switch(port)
+    {
+	case    1:
+	    DIGITAL_OUT_PWM1 = 0;
+	    IO_DIRECTION_PWM1 = IO_DIRECTION_OUT;
+	    break;
+	case    2:
+	    DIGITAL_OUT_PWM2 = 0;
+	    IO_DIRECTION_PWM2 = IO_DIRECTION_OUT;
+	    break;
+	case    3:
+	    DIGITAL_OUT_PWM3 = 0;
+	    IO_DIRECTION_PWM3 = IO_DIRECTION_OUT;
+	    break;
+	case    4:
+	    DIGITAL_OUT_PWM4 = 0;
+	    IO_DIRECTION_PWM4 = IO_DIRECTION_OUT;
+	    break;
+    }
+    Pwm_user_mask |= 1 << (port-1);
+    return OV_OK;
+}
+
+
+/**
+ *  Stop generating servo pulses for a PWM port and release the pin
+ *  to the master processor.  Timer3 is freed when the last port is
+ *  disabled.
+ *
+ *  \param  port    PWM OUT port, 1 to 4.
+ */
+
+/*
+ * History:
+ *  Oct 2026    J Bacon
+ */
+
+void    pwm_user_disable(unsigned char port)
+
+{
+    if ( ! VALID_PWM_USER_PORT(port) || ! (Pwm_user_mask & (1 << (port-1))) )
+	return;
+
+    Pwm_user_mask &= ~(1 << (port-1));
+    switch(port)
+    {
+	case    1:
+	    CCP2CON = 0;
+	    IO_DIRECTION_PWM1 = IO_DIRECTION_IN;
+	    break;
+	case    2:
+	    CCP3CON = 0;
+	    IO_DIRECTION_PWM2 = IO_DIRECTION_IN;
+	    break;
+	case    3:
+	    CCP4CON = 0;
+	    IO_DIRECTION_PWM3 = IO_DIRECTION_IN;
+	    break;
+	case    4:
+	    CCP5CON = 0;
+	    IO_DIRECTION_PWM4 = IO_DIRECTION_IN;
+	    break;
+    }
+
+    if ( Pwm_user_mask == 0 )
+	timer_free(3);
+}
+
+
+/**
+ *  Set the pulse width for a user-generated PWM port.  Called by
+ *  pwm_write(), which should normally be used instead.
+ *
+ *  \param  port    PWM OUT port, 1 to 4.
+ *  \param  val     -127 to +127, as for pwm_write().
+ */
+
+/*
+ * History:
+ *  Oct 2026    J Bacon
+ */
+
+void    pwm_user_write(unsigned char port, signed char val)
+
+{
+    unsigned short  ticks;
+
+    if ( ! VALID_PWM_USER_PORT(port) || ! (Pwm_user_mask & (1 << (port-1))) )
+	return;
+
+    ticks = PWM_USER_CENTER_TICKS +
+	(long)val * PWM_USER_RANGE_TICKS / PWM_MAX;
+
+    /* Don't let the ISR see half of the new value */
+    TIMER3_DISABLE_INTERRUPTS();
+    Pwm_user_ticks[port-1] = ticks;
+    TIMER3_ENABLE_INTERRUPTS();
+}
+
+
+/**
+ *  Set the interval between servo pulses on user-generated ports.
+ *
+ *  \param  overflows   Timer3 overflows (6.55ms each) per pulse, 1 to
+ *                      255.  The default is 3 (19.7ms).  1 (152 Hz)
+ *                      gives the fastest response, but not all servos
+ *                      and motor controllers accept it.
+ *
+ *  \returns    OV_OK on success, OV_BAD_PARAM for 0.
+ */
+
+/*
+ * History:
+ *  Oct 2026    J Bacon
+ */
+
+status_t    pwm_user_set_period(unsigned char overflows)
+
+{
+    if ( overflows == 0 )
+	return OV_BAD_PARAM;
+    Pwm_user_period = overflows;
+    return OV_OK;
+}
+
+/** @} */
+
+
+/*
+ *  Begin a pulse on every enabled port.  Called by the low priority
+ *  ISR on every Pwm_user_period'th Timer3 overflow, so Timer3 is
+ *  near 0 and the end time cannot wrap.
+ *
+ * History:
+ *  Oct 2026    J Bacon
+ */
+
+void    pwm_user_start_pulses(void)
+
+{
+    unsigned short  end;
+
+    PWM_USER_PULSE(1, CCP2CON, CCPR2L, CCPR2H);
+    PWM_USER_PULSE(2, CCP3CON, CCPR3L, CCPR3H);
+    PWM_USER_PULSE(3, CCP4CON, CCPR4L, CCPR4H);
+    PWM_USER_PULSE(4, CCP5CON, CCPR5L, CCPR5H);
+}
@@ -0,0 +1,63 @@
+/**************************************************************************
+* Description:
+*   Servo pulse generation on PWM OUT 1-4 by the user processor.
+*
+***************************************************************************
+*
+*   This code is free software: you can redistribute it and/or modify
+*   it under the terms of the GNU General Public License as published by
+*   the Free Software Foundation, either version 3 of the License, or
+*   (at your option) any later version.
+*
+*   This code is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License
+*   along with this code.  If not, see <http://www.gnu.org/licenses/>.
+*
+***************************************************************************/
+
+#ifndef __pwm_user_h__
+#define __pwm_user_h__
+
+#ifndef __general_h__
+#include "general.h"
+#endif
+
+/* PWM OUT 1-4 are wired to CCP2-CCP5 */
+#define PWM_USER_PORTS          4
+#define VALID_PWM_USER_PORT(p)  ( ((p) >= 1) && ((p) <= PWM_USER_PORTS) )
+
+/*
+ *  Pulse widths in Timer3 ticks (0.1us at prescale 1).  pwm_write()
+ *  values of -127, 0 and +127 give 1.0, 1.5 and 2.0ms pulses.
+ */
+#define PWM_USER_CENTER_TICKS   15000
+#define PWM_USER_RANGE_TICKS    5000
+
+/*
+ *  Pulses start every N Timer3 overflows of 6.55ms each.  The default
+ *  of 3 (19.7ms) matches the rate the master processor uses.
+ */
+#define PWM_USER_DEFAULT_PERIOD 3
+
+/* T3CON: 16-bit reads, Timer3 clocks CCP2-CCP5, prescale 1, on */
+#define PWM_USER_T3CON          0x89
+
+/* CCPxCON compare mode: pin set high now, cleared on match */
+#define CCP_COMPARE_SET_CLEAR   0x09
+
+extern volatile unsigned char   Pwm_user_mask;
+extern unsigned char            Pwm_user_period;
+extern unsigned char            Pwm_user_count;
+
+/* pwm_user.c */
+status_t pwm_user_enable(unsigned char port);
+void pwm_user_disable(unsigned char port);
+void pwm_user_write(unsigned char port, signed char val);
+status_t pwm_user_set_period(unsigned char overflows);
+void pwm_user_start_pulses(void);
+
+#endif
@@ -0,0 +1,42 @@
+#ifndef __ram_layout_h__
+#define __ram_layout_h__
+
+/*
+ *  18F8520 RAM layout, shared by platform.h and the SDCC start code
+ *  (crt0iz.c), which declares its own SFRs and so cannot include
+ *  platform.h.  Only #defines belong here.
+ */
+
+/*
+ *  RAM that is not cleared at startup, so it keeps its contents
+ *  through a reset (but not a power cycle).  Must match the NOINIT
+ *  section in the linker scripts.  clear_mem.asm (MCC18) has its own
+ *  copy as NOINIT_LOW, since MPASM cannot read this file.
+ *  To place variables there:
+ *
+ *  SDCC:   #pragma udata NOINIT Boot_count
+ *          unsigned char Boot_count;
+ *
+ *  MCC18:  #pragma udata NOINIT
+ *          unsigned char Boot_count;
+ *          #pragma udata
+ */
+#define NOINIT_BASE             0x7c0
+#define NOINIT_SIZE             0x34    /* Up to the debugger's 0x7f4 */
+
+/* The value clear_mem.asm was written for.  Change them together. */
+#define CLEAR_MEM_NOINIT_BASE   0x7c0
+#if NOINIT_BASE != CLEAR_MEM_NOINIT_BASE
+#error "NOINIT_BASE changed: update NOINIT_LOW in clear_mem.asm"
+#endif
+
+/*
+ *  SDCC software stack.  The #pragma stack in platform.h puts it here,
+ *  bank gpr2 is PROTECTED in vexsdcc.lkr so the linker puts nothing
+ *  else in it, and crt0iz.c does not clear it when FAST_BOOT is set.
+ *  Must stay on a 256-byte page.
+ */
+#define SDCC_STACK_ADDR         0x200
+#define SDCC_STACK_SIZE         0x100
+
+#endif
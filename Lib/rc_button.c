@@ -0,0 +1,108 @@
+/**************************************************************************
+*
+*   Entering codes with an RC button pair.
+*
+***************************************************************************
+*
+*   This code is free software: you can redistribute it and/or modify
+*   it under the terms of the GNU General Public License as published by
+*   the Free Software Foundation, either version 3 of the License, or
+*   (at your option) any later version.
+*
+*   This code is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License
+*   along with this code.  If not, see <http://www.gnu.org/licenses/>.
+*
+***************************************************************************/
+
+#include "platform.h"
+#include "general.h"
+#include "master.h"
+
+/**
+ *  \addtogroup RC
+ *  @{
+ */
+
+/**
+ *  Return a value indicating a binary sequence on RC button 'channel'.
+ *  This function allows a single button pair to be used to trigger up to
+ *  127 different actions.
+ *
+ *  This function keeps a static internal value and counter.
+ *  Each time this function is called, the buttons on channel are
+ *  sampled.  If the lower button is pressed, a 0 is inserted into least
+ *  significant bit of the value, and the counter incremented.  If the
+ *  upper button is pressed, a 1 is inserted and the counter is incremented.
+ *  If neither button is pressed, neither the value nor counter are changed.
+ *
+ *  A button being held down will only be counted once.  It must be released
+ *  and pressed again to advance the sequence.
+ *
+ *  When the counter reaches 'len', the function returns the value
+ *  based on the binary sequence of button presses.  For example, if
+ *  the sequence length is 3, and the user presses the sequence
+ *  lower, upper, upper, then the value returned is 011 binary
+ *  (3 in decimal).
+ *
+ *  Until then, it returns -1, indicating that the sequence is not
+ *  yet complete.
+ *
+ *  \param  channel Channel of button pair to read.
+ *  \param  len     Length of button sequence.
+ *
+ *  \returns    -1 if sequence is not complete, or value of binary sequence.
+ */
+
+signed char   rc_button_sequence(unsigned char channel, unsigned char len)
+
+{
+    static unsigned char    count = 0,
+			    val = 0,
+			    temp,
+			    digit;
+    static signed char      button,
+			    old_button;
+
+    if ( ! VALID_RC_CHANNEL(channel) )
+	return OV_BAD_PARAM;
+
+    switch ( button = rc_read_data(channel) )
+    {
+	case    -127:
+	    digit = 0;
+	    break;
+	case    +127:
+	    digit = 1;
+	    break;
+	default:
+	    digit = 2;
+	    break;
+    }
+    
+    /*
+     *  Register only distinct button pressed.  This function could be
+     *  called thousands of times while a button is being held down,
+     *  but this does not constitute a button sequence.
+     */
+    if ( (digit < 2) && (button != old_button) )
+    {
+	++count;
+	val = (val << 1) + digit;     /* Insert new digit in LSB */
+    }
+    old_button = button;
+    if ( count == len )
+    {
+	temp = val;
+	count = val = 0;
+	return temp;
+    }
+    else
+	return OV_SEQUENCE_INCOMPLETE;
+}
+
+/** @} */
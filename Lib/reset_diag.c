@@ -0,0 +1,280 @@
+/**************************************************************************
+*
+*   Reset cause detection and a log that survives warm resets.
+*
+*   When the PIC resets under load, e.g. from a brown-out while the
+*   motors stall or a hardware stack overflow, the startup code clears
+*   RAM and the evidence is gone.  This module keeps its state in the
+*   noinit section (see NOINIT_BASE in ram_layout.h), which is not
+*   cleared, so after a warm reset the program can still tell why it
+*   reset, how often each cause has occurred, and the last few records
+*   it logged before the reset.  The log is only lost on power-up.
+*
+***************************************************************************
+*
+*   This code is free software: you can redistribute it and/or modify
+*   it under the terms of the GNU General Public License as published by
+*   the Free Software Foundation, either version 3 of the License, or
+*   (at your option) any later version.
+*
+*   This code is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License
+*   along with this code.  If not, see <http://www.gnu.org/licenses/>.
+*
+***************************************************************************/
+
+#include <string.h>
+#include "platform.h"
+#include "timer.h"
+#include "reset_diag.h"
+#include "ov_printf.h"
+
+/* Not cleared at startup.  See the linker scripts. */
+#ifdef __SDCC
+#pragma udata NOINIT Reset_diag
+reset_diag_t    Reset_diag;
+#else
+#pragma udata NOINIT
+reset_diag_t    Reset_diag;
+#pragma udata
+#endif
+
+/* Compile-time check that the log fits in the noinit section */
+typedef char Reset_diag_fits[(sizeof(reset_diag_t) <= NOINIT_SIZE) ? 1 : -1];
+
+/**
+ *  \defgroup reset_diag Reset Diagnostics
+ *  @{
+ *
+ *  These functions report why the controller last reset, and keep
+ *  a small log of records that survives warm resets, so that a field
+ *  failure can be diagnosed later without a serial cable attached
+ *  when it happened.
+ *
+ *  \code
+ *  controller_init();
+ *  if ( reset_diag_cause() == RESET_CAUSE_BROWN_OUT )
+ *      reduce_motor_limits();
+ *  ...
+ *  reset_diag_log(RESET_DIAG_USER + 1, autonomous_step);
+ *  \endcode
+ */
+
+/**
+ *  Determine the cause of the latest reset, update the counters, log
+ *  the reset and rearm the RCON and STKPTR flags for the next one.
+ *  Called by controller_init() before anything else, since the flags
+ *  are only meaningful until they are rearmed.  TO cannot be set by
+ *  writing RCON, so it is rearmed with a CLRWDT.
+ *
+ *  On power-up, or if the log does not look valid, the log is
+ *  cleared first.
+ */
+
+/*
+ * History:
+ *  Oct 2026    J Bacon
+ */
+
+void    reset_diag_init(void)
+
+{
+    unsigned char   rcon = RCON,
+		    stkptr = STKPTR,
+		    cause;
+
+    /* BOR is undefined after power on, so test POR first */
+    if ( ! (rcon & RESET_RCON_POR) )
+	cause = RESET_CAUSE_POWER_ON;
+    else if ( stkptr & RESET_STKPTR_STKFUL )
+	cause = RESET_CAUSE_STACK_OVERFLOW;
+    else if ( stkptr & RESET_STKPTR_STKUNF )
+	cause = RESET_CAUSE_STACK_UNDERFLOW;
+    else if ( ! (rcon & RESET_RCON_BOR) )
+	cause = RESET_CAUSE_BROWN_OUT;
+    else if ( ! (rcon & RESET_RCON_TO) )
+	cause = RESET_CAUSE_WATCHDOG;
+    else if ( ! (rcon & RESET_RCON_RI) )
+	cause = RESET_CAUSE_RESET_INSTR;
+    else
+	cause = RESET_CAUSE_MCLR;
+
+    /*
+     *  POR, BOR and RI are set by software, STKFUL and STKUNF cleared.
+     *  TO is only set by power-up, CLRWDT or SLEEP, and the SDCC start
+     *  code never runs CLRWDT, so without this every reset after one
+     *  watchdog reset would look like another.
+     */
+    RCON |= RESET_RCON_POR | RESET_RCON_BOR | RESET_RCON_RI;
+    _ASM
+    clrwdt
+    _ENDASM;
+    STKPTR &= ~(RESET_STKPTR_STKFUL | RESET_STKPTR_STKUNF);
+
+    if ( (cause == RESET_CAUSE_POWER_ON) ||
+	 (Reset_diag.magic != RESET_DIAG_MAGIC) ||
+	 (Reset_diag.head >= RESET_DIAG_RECORDS) ||
+	 (Reset_diag.records > RESET_DIAG_RECORDS) )
+	reset_diag_clear();
+
+    Reset_diag.cause = cause;
+    if ( Reset_diag.counts[cause] != 255 )
+	++Reset_diag.counts[cause];
+    reset_diag_log(RESET_DIAG_RESET, cause);
+}
+
+
+/**
+ *  Return the cause of the latest reset, one of the RESET_CAUSE_*
+ *  constants.  RESET_CAUSE_MCLR includes resets by the master
+ *  processor, e.g. after a program download.
+ */
+
+/*
+ * History:
+ *  Oct 2026    J Bacon
+ */
+
+unsigned char   reset_diag_cause(void)
+
+{
+    return Reset_diag.cause;
+}
+
+
+/**
+ *  Return how many resets of a given cause have occurred since the
+ *  controller was powered up or reset_diag_clear() was called.
+ *
+ *  \param  cause   One of the RESET_CAUSE_* constants.
+ *
+ *  \returns    The count, which stops at 255, or 0 for an invalid cause.
+ */
+
+/*
+ * History:
+ *  Oct 2026    J Bacon
+ */
+
+unsigned char   reset_diag_count(unsigned char cause)
+
+{
+    if ( cause >= RESET_CAUSES )
+	return 0;
+    return Reset_diag.counts[cause];
+}
+
+
+/**
+ *  Add a record to the log, replacing the oldest if it is full.
+ *  Records are timestamped in 10ms units of the system timer.
+ *
+ *  \param  code    RESET_DIAG_USER or above.  Codes below are used
+ *                  by the library.
+ *  \param  value   Anything that helps, e.g. a state machine step.
+ *
+ *  Log only occasional events, such as mode changes and autonomous
+ *  steps, or the reset records will be pushed out.  Not for use
+ *  from an interrupt handler.
+ */
+
+/*
+ * History:
+ *  Oct 2026    J Bacon
+ */
+
+void    reset_diag_log(unsigned char code, unsigned char value)
+
+{
+    reset_diag_record_t *record = &Reset_diag.ring[Reset_diag.head];
+
+    record->time = SYSTEM_TIMER_MS() / 10;
+    record->code = code;
+    record->value = value;
+    Reset_diag.head = (Reset_diag.head + 1) & (RESET_DIAG_RECORDS - 1);
+    if ( Reset_diag.records < RESET_DIAG_RECORDS )
+	++Reset_diag.records;
+}
+
+
+/**
+ *  Read a record from the log.
+ *
+ *  \param  age     0 for the newest record, 1 for the one before, etc.
+ *  \param  record  Address of structure to receive the record.
+ *
+ *  \returns    OV_OK on success, OV_BAD_PARAM if there is no record
+ *              of that age.
+ */
+
+/*
+ * History:
+ *  Oct 2026    J Bacon
+ */
+
+status_t    reset_diag_read(unsigned char age, reset_diag_record_t *record)
+
+{
+    if ( age >= Reset_diag.records )
+	return OV_BAD_PARAM;
+    *record = Reset_diag.ring[(Reset_diag.head - 1 - age) &
+			      (RESET_DIAG_RECORDS - 1)];
+    return OV_OK;
+}
+
+
+/**
+ *  Clear the log and all counters.
+ */
+
+/*
+ * History:
+ *  Oct 2026    J Bacon
+ */
+
+void    reset_diag_clear(void)
+
+{
+    unsigned char   cause = Reset_diag.cause;
+
+    memset(&Reset_diag, 0, sizeof(Reset_diag));
+    Reset_diag.magic = RESET_DIAG_MAGIC;
+    Reset_diag.cause = cause;
+}
+
+
+/**
+ *  Print the reset counters and the log, newest first, to the serial
+ *  port.
+ */
+
+/*
+ * History:
+ *  Oct 2026    J Bacon
+ */
+
+void    reset_diag_print(void)
+
+{
+    reset_diag_record_t record;
+    unsigned char       c;
+
+    ov_printf("Reset: cause %d por %d so %d su %d bor %d wdt %d ri %d mclr %d\n",
+	Reset_diag.cause,
+	Reset_diag.counts[RESET_CAUSE_POWER_ON],
+	Reset_diag.counts[RESET_CAUSE_STACK_OVERFLOW],
+	Reset_diag.counts[RESET_CAUSE_STACK_UNDERFLOW],
+	Reset_diag.counts[RESET_CAUSE_BROWN_OUT],
+	Reset_diag.counts[RESET_CAUSE_WATCHDOG],
+	Reset_diag.counts[RESET_CAUSE_RESET_INSTR],
+	Reset_diag.counts[RESET_CAUSE_MCLR]);
+    for (c = 0; reset_diag_read(c, &record) == OV_OK; ++c)
+	ov_printf("  %u0ms code %d value %d\n",
+	    record.time, record.code, record.value);
+}
+
+/** @} */
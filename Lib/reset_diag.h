@@ -0,0 +1,83 @@
+/**************************************************************************
+* Description:
+*   Reset cause detection and a log that survives warm resets.
+*
+***************************************************************************
+*
+*   This code is free software: you can redistribute it and/or modify
+*   it under the terms of the GNU General Public License as published by
+*   the Free Software Foundation, either version 3 of the License, or
+*   (at your option) any later version.
+*
+*   This code is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License
+*   along with this code.  If not, see <http://www.gnu.org/licenses/>.
+*
+***************************************************************************/
+
+#ifndef __reset_diag_h__
+#define __reset_diag_h__
+
+#ifndef __general_h__
+#include "general.h"
+#endif
+
+/* Reset causes, in the order they are tested */
+#define RESET_CAUSE_POWER_ON        0
+#define RESET_CAUSE_STACK_OVERFLOW  1
+#define RESET_CAUSE_STACK_UNDERFLOW 2
+#define RESET_CAUSE_BROWN_OUT       3
+#define RESET_CAUSE_WATCHDOG        4
+#define RESET_CAUSE_RESET_INSTR     5
+#define RESET_CAUSE_MCLR            6   /* Including resets by the master */
+#define RESET_CAUSES                7
+
+/* RCON and STKPTR flags.  The RCON flags are active low. */
+#define RESET_RCON_BOR      0x01
+#define RESET_RCON_POR      0x02
+#define RESET_RCON_TO       0x08
+#define RESET_RCON_RI       0x10
+#define RESET_STKPTR_STKUNF 0x40
+#define RESET_STKPTR_STKFUL 0x80
+
+/* Record codes below this are used by the library */
+#define RESET_DIAG_USER     0x80
+#define RESET_DIAG_RESET    0x01    /* value = RESET_CAUSE_* */
+#define RESET_DIAG_MEM_FAULT 0x02   /* value = MEM_FAULT_* */
+
+/* Must be a power of 2, and the whole log must fit in NOINIT_SIZE */
+#define RESET_DIAG_RECORDS  8
+
+#define RESET_DIAG_MAGIC    0x5244  /* "RD" */
+
+typedef struct
+{
+    unsigned short  time;       /* SYSTEM_TIMER_MS() / 10, wraps at 11 min */
+    unsigned char   code;       /* RESET_DIAG_* */
+    unsigned char   value;
+}   reset_diag_record_t;
+
+typedef struct
+{
+    unsigned short      magic;
+    unsigned char       cause;                  /* Of the latest reset */
+    unsigned char       head;                   /* Next record to write */
+    unsigned char       records;                /* Valid records */
+    unsigned char       counts[RESET_CAUSES];   /* Since power on, max 255 */
+    reset_diag_record_t ring[RESET_DIAG_RECORDS];
+}   reset_diag_t;
+
+/* reset_diag.c */
+void reset_diag_init(void);
+unsigned char reset_diag_cause(void);
+unsigned char reset_diag_count(unsigned char cause);
+void reset_diag_log(unsigned char code, unsigned char value);
+status_t reset_diag_read(unsigned char age, reset_diag_record_t *record);
+void reset_diag_clear(void);
+void reset_diag_print(void);
+
+#endif
@@ -0,0 +1,158 @@
+/**************************************************************************
+*
+*   Apply a robot_config_t describing how each port is used.
+*
+*   Rather than a sequence of io_set_direction(), shaft_encoder_*(),
+*   sonar_init() and timer_start() calls, each checked only when it
+*   runs, a program can describe its robot in one constant table in
+*   program memory, check its constants at compile time with the
+*   ROBOT_CHECK_*() macros, and apply it with one robot_configure()
+*   call.
+*
+***************************************************************************
+*
+*   This code is free software: you can redistribute it and/or modify
+*   it under the terms of the GNU General Public License as published by
+*   the Free Software Foundation, either version 3 of the License, or
+*   (at your option) any later version.
+*
+*   This code is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License
+*   along with this code.  If not, see <http://www.gnu.org/licenses/>.
+*
+***************************************************************************/
+
+#include "platform.h"
+#include "io.h"
+#include "timer.h"
+#include "shaft_encoder.h"
+#include "sonar.h"
+#include "pwm_output.h"
+#include "robot_config.h"
+
+static status_t robot_config_check(const ROM robot_config_t *config);
+
+/**
+ *  \addtogroup controller
+ *  @{
+ */
+
+/**
+ *  Configure I/O ports, encoders, sonars, timers and motor directions
+ *  from a robot description.  The whole description is checked before
+ *  anything is changed, so an inconsistent one leaves the controller
+ *  as it was.
+ *
+ *  \param  config  Robot description, normally a constant in program
+ *                  memory.
+ *
+ *  \returns    OV_OK on success, OV_BAD_PARAM if the description is
+ *              inconsistent (e.g. a digital output among the analog
+ *              ports, or an interrupt port used twice) or a device
+ *              could not be enabled.
+ *
+ *  \code
+ *  #define OUTPUTS     IO_PORT_BIT(SONAR_OUTPUT_PORT)
+ *  #define ENCODERS    (ROBOT_IPORT_BIT(1) | ROBOT_IPORT_BIT(2))
+ *
+ *  ROBOT_CHECK_DIGITAL_MASK(OUTPUTS, ANALOG_PORTS);
+ *  ROBOT_CHECK_DISJOINT(ENCODERS, ROBOT_IPORT_BIT(SONAR_INTERRUPT_PORT));
+ *
+ *  static const ROM robot_config_t Robot =
+ *  {
+ *      ANALOG_PORTS, OUTPUTS, 0, ENCODERS,
+ *      1, { { SONAR_INTERRUPT_PORT, SONAR_OUTPUT_PORT } },
+ *      ROBOT_TIMER_BIT(1), ROBOT_PWM_BIT(LEFT_DRIVE_PORT)
+ *  };
+ *  ...
+ *  robot_configure(&Robot);
+ *  \endcode
+ */
+
+/*
+ * History:
+ *  Oct 2026    J Bacon
+ */
+
+status_t    robot_configure(const ROM robot_config_t *config)
+
+{
+    unsigned char   c,
+		    bit;
+    status_t        status = OV_OK;
+
+    if ( robot_config_check(config) != OV_OK )
+	return OV_BAD_PARAM;
+
+    io_set_analog_port_count(config->analog_ports);
+
+    /* Set output latches before turning the drivers on */
+    io_write_digital_mask(config->digital_outputs, config->output_values);
+    for (c = 1; c <= TOTAL_IO_PORTS; ++c)
+	io_set_direction(c, (config->digital_outputs & IO_PORT_BIT(c)) ?
+			    IO_DIRECTION_OUT : IO_DIRECTION_IN);
+
+    for (c = 1, bit = 1; c <= TOTAL_INTERRUPT_PORTS; ++c, bit <<= 1)
+	if ( (config->encoders & bit) &&
+	     (shaft_encoder_enable_std(c) != OV_OK) )
+	    status = OV_BAD_PARAM;
+
+    for (c = 0; c < config->sonar_count; ++c)
+	if ( sonar_init(config->sonar[c].interrupt_port,
+			config->sonar[c].output_port) != OV_OK )
+	    status = OV_BAD_PARAM;
+
+    for (c = 1, bit = 1; c <= 4; ++c, bit <<= 1)
+	if ( config->timers & bit )
+	    timer_start(c);
+
+    for (c = 1, bit = 1; c <= TOTAL_PWM_PORTS; ++c, bit <<= 1)
+	pwm_set_reverse(c, (config->reversed_motors & bit) != 0);
+
+    return status;
+}
+
+/** @} */
+
+
+/*
+ *  Check what the ROBOT_CHECK_*() macros could not, for descriptions
+ *  built from variables or where the checks were left out.
+ *
+ * History:
+ *  Oct 2026    J Bacon
+ */
+
+static status_t robot_config_check(const ROM robot_config_t *config)
+
+{
+    unsigned char   c,
+		    iports;
+    unsigned short  outputs;
+
+    if ( (config->analog_ports > TOTAL_IO_PORTS) ||
+	 (config->analog_ports == 15) ||
+	 (config->sonar_count > ROBOT_MAX_SONARS) ||
+	 (config->digital_outputs & ROBOT_ANALOG_MASK(config->analog_ports)) )
+	return OV_BAD_PARAM;
+
+    /* Each interrupt port and sonar trigger may be used only once */
+    iports = config->encoders;
+    outputs = 0;
+    for (c = 0; c < config->sonar_count; ++c)
+    {
+	if ( ! VALID_INTERRUPT_PORT(config->sonar[c].interrupt_port) ||
+	     ! VALID_IO_PORT(config->sonar[c].output_port) ||
+	     (config->sonar[c].output_port <= config->analog_ports) ||
+	     (iports & ROBOT_IPORT_BIT(config->sonar[c].interrupt_port)) ||
+	     (outputs & IO_PORT_BIT(config->sonar[c].output_port)) )
+	    return OV_BAD_PARAM;
+	iports |= ROBOT_IPORT_BIT(config->sonar[c].interrupt_port);
+	outputs |= IO_PORT_BIT(config->sonar[c].output_port);
+    }
+    return OV_OK;
+}
@@ -0,0 +1,90 @@
+/**************************************************************************
+* Description:
+*   Declarative description of how a robot's ports are used.
+*
+***************************************************************************
+*
+*   This code is free software: you can redistribute it and/or modify
+*   it under the terms of the GNU General Public License as published by
+*   the Free Software Foundation, either version 3 of the License, or
+*   (at your option) any later version.
+*
+*   This code is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License
+*   along with this code.  If not, see <http://www.gnu.org/licenses/>.
+*
+***************************************************************************/
+
+#ifndef __robot_config_h__
+#define __robot_config_h__
+
+#ifndef __general_h__
+#include "general.h"
+#endif
+
+#ifndef __platform_h__
+#include "platform.h"
+#endif
+
+#define ROBOT_MAX_SONARS        2
+
+/* Bits for the masks below.  See also IO_PORT_BIT() in io.h. */
+#define ROBOT_IPORT_BIT(port)   (1 << ((port)-1))   /* Interrupt port */
+#define ROBOT_TIMER_BIT(timer)  (1 << ((timer)-1))  /* Timer 1 to 4 */
+#define ROBOT_PWM_BIT(port)     (1 << ((port)-1))   /* PWM port */
+
+/* I/O ports 1 to n, which are analog when n analog ports are selected */
+#define ROBOT_ANALOG_MASK(n)    ((unsigned short)((1UL << (n)) - 1))
+
+typedef struct
+{
+    unsigned char   interrupt_port;     /* Echo */
+    unsigned char   output_port;        /* Trigger, a digital I/O port */
+}   robot_sonar_t;
+
+typedef struct
+{
+    unsigned char   analog_ports;       /* See io_set_analog_port_count() */
+    unsigned short  digital_outputs;    /* IO_PORT_BIT()s, rest are inputs */
+    unsigned short  output_values;      /* Initial states of the outputs */
+    unsigned char   encoders;           /* ROBOT_IPORT_BIT()s, standard encoders */
+    unsigned char   sonar_count;
+    robot_sonar_t   sonar[ROBOT_MAX_SONARS];
+    unsigned char   timers;             /* ROBOT_TIMER_BIT()s to start */
+    unsigned char   reversed_motors;    /* ROBOT_PWM_BIT()s, see pwm_set_reverse() */
+}   robot_config_t;
+
+/*
+ *  Compile-time checks for the constants a configuration is built from.
+ *  A failed check is reported by the compiler as an array with a
+ *  negative size on the line of the check.
+ *
+ *  ROBOT_CONFIG_CHECK(cond)    any constant condition
+ *  ROBOT_CHECK_ANALOG(n)       n is an analog port count the PIC supports
+ *  ROBOT_CHECK_DIGITAL(port, n)    port is digital with n analog ports
+ *  ROBOT_CHECK_DIGITAL_MASK(mask, n)   all ports in mask are digital
+ *  ROBOT_CHECK_DISJOINT(a, b)  no port is in both masks, e.g. encoder
+ *                              and sonar interrupt ports
+ */
+#define ROBOT_CONFIG_CHECK(cond)        ROBOT_CHECK_AT(cond, __LINE__)
+#define ROBOT_CHECK_AT(cond, line)      ROBOT_CHECK_AT2(cond, line)
+#define ROBOT_CHECK_AT2(cond, line) \
+    typedef char Robot_config_check_##line[(cond) ? 1 : -1]
+
+#define ROBOT_CHECK_ANALOG(n) \
+    ROBOT_CONFIG_CHECK(((n) <= TOTAL_IO_PORTS) && ((n) != 15))
+#define ROBOT_CHECK_DIGITAL(port, n) \
+    ROBOT_CONFIG_CHECK(((port) > (n)) && ((port) <= TOTAL_IO_PORTS))
+#define ROBOT_CHECK_DIGITAL_MASK(mask, n) \
+    ROBOT_CONFIG_CHECK(((mask) & ROBOT_ANALOG_MASK(n)) == 0)
+#define ROBOT_CHECK_DISJOINT(a, b) \
+    ROBOT_CONFIG_CHECK(((a) & (b)) == 0)
+
+/* robot_config.c */
+status_t robot_configure(const ROM robot_config_t *config);
+
+#endif
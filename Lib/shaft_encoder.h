@@ -24,14 +24,18 @@
 #ifndef __shaft_encoder_h__
 #define __shaft_encoder_h__
 
+#ifndef __platform_h__
+#include "platform.h"
+#endif
+
 #ifndef __general_h__
 #include "general.h"
 #endif
 
-extern unsigned char            Encoder_on_iport[6];
-extern volatile unsigned int    Encoder_ticks[6];
+extern NEAR unsigned char       Encoder_on_iport[6];
+extern NEAR volatile unsigned int   Encoder_ticks[6];
 extern unsigned char            Quad_input_port[6];
-extern volatile unsigned char   Porta_sample, Portf_sample, Porth_sample;
+extern NEAR volatile unsigned char  Porta_sample, Portf_sample, Porth_sample;
 
 #define ENCODER_STD     1
 #define ENCODER_QUAD    2
@@ -87,6 +91,8 @@ void quad_encoder_isr(unsigned char port);
 int     shaft_encoder_read_quad(unsigned char port);
 status_t    shaft_encoder_enable_std(unsigned char interrupt_port);
 status_t    shaft_encoder_enable_quad(unsigned char interrupt_port,unsigned char input_port);
+
+/* shaft_tps.c */
 status_t    shaft_tps_run(shaft_t shafts[], unsigned char count);
 status_t    shaft_tps_init(shaft_t *sp,
 		    unsigned long timer_limit, unsigned short tick_limit,
@@ -46,7 +46,7 @@
 #include "debug.h"
 #include "sonar.h"
 
-extern unsigned char           Sonar_on_iport[6];
+extern NEAR unsigned char      Sonar_on_iport[6];
 extern unsigned char           Sonar_output_port[6];
 extern volatile unsigned char  Sonar_data_available[6];
 extern volatile unsigned short Sonar_echo_time[6];
@@ -197,7 +197,7 @@ status_t    sonar_init(unsigned char interrupt_port,
 		       unsigned char output_port)
 
 {
-    if ( ! VALID_INTERRUPT_PORT(interrupt_port) ||
+    if ( ! OV_USE_SONAR || ! VALID_INTERRUPT_PORT(interrupt_port) ||
 	 ! VALID_DIGITAL_PORT(output_port) )
 	return OV_BAD_PARAM;
     
@@ -2,6 +2,10 @@
 #ifndef __sonar_h_
 #define __sonar_h_
 
+#ifndef __platform_h__
+#include "platform.h"
+#endif
+
 #ifndef __general_h__
 #include "general.h"
 #endif
@@ -22,7 +26,7 @@
 #define ECHO_TIME_TO_CM(t)      ( ((unsigned long)TIMER0_PRESCALE * (t) - 400) / 583 )
 
 extern volatile unsigned char   Sonar_data_available[];
-extern unsigned char            Sonar_on_iport[];
+extern NEAR unsigned char       Sonar_on_iport[];
 
 /* 
  *  These are used in ISRs, so we use macros for speed.  MCC18 doesn't
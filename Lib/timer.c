@@ -47,11 +47,11 @@
 #include "sonar.h"
 
 /* Timer interrupt (overflow) counts.  Extend each timer to 32 bits */
-extern unsigned int    Timer0_overflows;
-extern unsigned int    Timer1_overflows;
-extern unsigned long   Timer2_overflows;
-extern unsigned int    Timer3_overflows;
-extern unsigned long   Timer4_overflows;
+extern NEAR volatile unsigned int   Timer0_overflows;
+extern volatile unsigned int    Timer1_overflows;
+extern volatile unsigned long   Timer2_overflows;
+extern volatile unsigned int    Timer3_overflows;
+extern volatile unsigned long   Timer4_overflows;
 
 unsigned char   Timer_allocated[4];
 
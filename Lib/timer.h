@@ -24,6 +24,10 @@
 #ifndef __timer_h__
 #define __timer_h__
 
+#ifndef __platform_h__
+#include "platform.h"
+#endif
+
 #define TIMER0_PRESCALE_MASK_2    0x00
 #define TIMER0_PRESCALE_MASK_4    0x01
 #define TIMER0_PRESCALE_MASK_8    0x02
@@ -496,11 +500,16 @@
 
 #define TIMER0_INTERRUPT_FLAG       INTCONbits.TMR0IF
 
-extern unsigned int    Timer0_overflows;
-extern unsigned int    Timer1_overflows;
-extern unsigned long   Timer2_overflows;
-extern unsigned int    Timer3_overflows;
-extern unsigned long   Timer4_overflows;
+/* Timer_allocated[] states */
+#define TIMER_FREE          0
+#define TIMER_ALLOCATED     1   /* By timer_allocate() */
+#define TIMER_LIBRARY       2   /* By pwm_user, adc_scan or debounce */
+
+extern NEAR volatile unsigned int   Timer0_overflows;
+extern volatile unsigned int    Timer1_overflows;
+extern volatile unsigned long   Timer2_overflows;
+extern volatile unsigned int    Timer3_overflows;
+extern volatile unsigned long   Timer4_overflows;
 
 /* timer.c */
 unsigned long timer0_read32(void);
@@ -4,6 +4,10 @@
 
 extern unsigned char    Timer_allocated[4];
 
+/* May the program reprogram this timer? */
+#define TIMER_USER_OK(t) \
+    ( ((t) >= 1) && ((t) <= 4) && (Timer_allocated[(t)-1] != TIMER_LIBRARY) )
+
 /**
  * \defgroup timer_simple Simplified Timer Interface
  *  @{
@@ -58,7 +62,8 @@ unsigned long   timer_read_ms(unsigned char timer)
 
 
 /**
- *  Set timer to 0.
+ *  Set timer to 0.  Timers in use by pwm_user_enable(), adc_scan_enable()
+ *  or debounce_watch() are left alone.
  *
  *  \param  timer   An integer from 1 to 4, inclusive, indicating which
  *                  timer to use.  The Vex PIC processor has 5
@@ -69,6 +74,8 @@ unsigned long   timer_read_ms(unsigned char timer)
 
 void    timer_clear(unsigned char timer)
 {
+    if ( ! TIMER_USER_OK(timer) )
+	return;
     switch(timer)
     {
 	case    1:
@@ -106,7 +113,9 @@ void    timer_clear(unsigned char timer)
 
 
 /**
- *  Start timer running.      
+ *  Start timer running.  Timers in use by pwm_user_enable(),
+ *  adc_scan_enable() or debounce_watch() are left alone, since
+ *  reprogramming them would break those functions.
  *
  *  \param  timer   An integer from 1 to 4, inclusive, indicating which
  *                  timer to use.  The Vex PIC processor has 5
@@ -117,8 +126,11 @@ void    timer_clear(unsigned char timer)
 
 void    timer_start(unsigned char timer)
 {
+    if ( ! TIMER_USER_OK(timer) )
+	return;
     switch(timer)
     {
+#if OV_USE_TIMER1
 	case    1:
 	    TIMER1_STOP();
 	    TIMER1_SET_WIDTH_16();
@@ -127,6 +139,8 @@ void    timer_start(unsigned char timer)
 	    TIMER1_ENABLE_INTERRUPTS();
 	    TIMER1_START();
 	    return;
+#endif
+#if OV_USE_TIMER2
 	case    2:
 	    TIMER2_STOP();
 	    TIMER2_SET_PRESCALE(TIMER2_PRESCALE_MASK_16);
@@ -134,6 +148,8 @@ void    timer_start(unsigned char timer)
 	    TIMER2_ENABLE_INTERRUPTS();
 	    TIMER2_START();
 	    return;
+#endif
+#if OV_USE_TIMER3
 	case    3:
 	    TIMER3_STOP();
 	    TIMER3_SET_WIDTH_16();
@@ -142,6 +158,8 @@ void    timer_start(unsigned char timer)
 	    TIMER3_ENABLE_INTERRUPTS();
 	    TIMER3_START();
 	    return;
+#endif
+#if OV_USE_TIMER4
 	case    4:
 	    TIMER4_STOP();
 	    TIMER4_SET_PRESCALE(TIMER4_PRESCALE_MASK_16);
@@ -149,12 +167,14 @@ void    timer_start(unsigned char timer)
 	    TIMER4_ENABLE_INTERRUPTS();
 	    TIMER4_START();
 	    return;
+#endif
     }
 }
 
 
 /**
- *  Stop timer from running.
+ *  Stop timer from running.  Pass only a timer returned by
+ *  timer_allocate().
  *
  *  \param  timer   An integer from 1 to 4, inclusive, indicating which
  *                  timer to use.  The Vex PIC processor has 5
@@ -193,41 +213,51 @@ void    timer_stop(unsigned char timer)
 
 /**
  *  Select an available timer (one that is not currently running).
+ *  Timers left out in openvex_config.h are never selected.
  *
  *  \returns    An integer timer number for use as an argument to other
- *              timer functions.
+ *              timer functions, or 0 if none is available.
  */
 
 unsigned char   timer_allocate(void)
 {
     /* Allocate 16 bit timers 1 and 3 before 8 bit timers 2 and 4 */
+#if OV_USE_TIMER1
     if ( ! Timer_allocated[0] )
     {
-	Timer_allocated[0] = 1;
+	Timer_allocated[0] = TIMER_ALLOCATED;
 	return 1;
     }
-    else if ( ! Timer_allocated[2] )
+#endif
+#if OV_USE_TIMER3
+    if ( ! Timer_allocated[2] )
     {
-	Timer_allocated[2] = 1;
+	Timer_allocated[2] = TIMER_ALLOCATED;
 	return 3;
     }
-    else if ( ! Timer_allocated[1] )
+#endif
+#if OV_USE_TIMER2
+    if ( ! Timer_allocated[1] )
     {
-	Timer_allocated[1] = 1;
+	Timer_allocated[1] = TIMER_ALLOCATED;
 	return 2;
     }
-    else if ( ! Timer_allocated[3] )
+#endif
+#if OV_USE_TIMER4
+    if ( ! Timer_allocated[3] )
     {
-	Timer_allocated[3] = 1;
+	Timer_allocated[3] = TIMER_ALLOCATED;
 	return 4;
     }
+#endif
     return 0;
 }
 
 /**
  *  Free a timer that was previously allocated with timer_allocate().
  *  This will make it available to the next timer_allocate() call.
- *  This does not
+ *  The library also uses this to release its own timers, so pass only
+ *  a timer returned by timer_allocate().
  *  
  *  \param  timer   Integer from 1 to 4 inclusive, specifying which timer
  *                  to free.
@@ -237,7 +267,7 @@ void    timer_free(unsigned char timer)
 
 {
     timer_stop(timer);
-    Timer_allocated[timer-1] = 0;
+    Timer_allocated[timer-1] = TIMER_FREE;
 }
 
 /** @} */
@@ -7,6 +7,9 @@
 #include "vex_spi.h"
 #include "master.h"
 #include "interrupts.h"
+#include "link_stats.h"
+#include "timer.h"
+#include "latency.h"
 
 /********************************************************************
  *  Double buffers for SPI interface 
@@ -21,10 +24,11 @@
  *  wrong buffer.
  *
  *  User_rxdata is simply a pointer to Rx_buff[Rx_user_buff_index].
+ *  The ISR moves it, so the pointer itself is volatile too.
  */
 volatile rx_data_t      Rx_buff[2];
 volatile unsigned char  Rx_user_buff_index = INITIAL_BUFF_INDEX;
-volatile rx_data_t      *User_rxdata = Rx_buff + INITIAL_BUFF_INDEX;
+volatile rx_data_t      * volatile User_rxdata = Rx_buff + INITIAL_BUFF_INDEX;
 
 /*
  *  Tx_user_buff_index controls mutually exclusive access to the
@@ -42,6 +46,28 @@ tx_data_t               User_txdata;
 
 volatile spi_status_t   Spi_status;
 
+/* Packets completely received, for controller_submit_data(WAIT) */
+volatile unsigned char  Spi_rx_packets = 0;
+
+/* Maintained by the ISR below.  See link_stats.c. */
+volatile link_stats_t   Link_stats;
+
+/*
+ *  Used for every byte of every packet, so kept in the access bank.
+ *  See ISR_HOT in platform.h.
+ */
+#ifdef __SDCC
+#pragma udata access ISR_HOT tx_ptr rx_ptr Spi_byte_count
+#else
+#pragma udata access ISR_HOT
+#endif
+static NEAR volatile unsigned char  *tx_ptr;
+static NEAR volatile unsigned char  *rx_ptr;
+static NEAR volatile unsigned char  Spi_byte_count;
+#ifndef __SDCC
+#pragma udata
+#endif
+
 //volatile unsigned short Spi_isr_start;
 //volatile unsigned short Spi_isr_end;
 
@@ -95,11 +121,10 @@ void InterruptVectorHigh(void) NAKED_INTERRUPT_VECTOR(1)
 void    InterruptHandlerHigh(void) INTERRUPT
 
 {
-    static volatile unsigned char   *tx_ptr;
-    static volatile unsigned char   *rx_ptr;
-    static volatile unsigned char   Spi_byte_count;
     static unsigned char            spi_ch;
     static unsigned char            packet_num = 0;
+    static unsigned char            last_rx_packet_num;
+    unsigned char                   rx_packet_num;
 
     /*
      *  Time ISR.  TMR0 clock has a 100ns period (same as instruction cycle)
@@ -121,6 +146,7 @@ void    InterruptHandlerHigh(void) INTERRUPT
     {
 	INTCONbits.INT0F = 0;   /* Clear interrupt condition. */
 	Spi_byte_count = sizeof(rx_data_t);
+	Spi_status.receiving = 1;
 	IPR1bits.SSPIP = 1;     /* Set SPI for high-priority interrupts */
     
 	/*
@@ -143,6 +169,13 @@ void    InterruptHandlerHigh(void) INTERRUPT
 	/* spi_ch is never used.  Just to clear BF? */
 	spi_ch = SSPBUF;
 	SSPBUF = *tx_ptr++;
+	
+	/* The user's last submitted data is on its way.  See latency.c */
+	if ( Latency_tx_pending == LATENCY_SUBMITTED )
+	{
+	    TIMER0_READ16(Latency_tx_time);
+	    Latency_tx_pending = LATENCY_SENT;
+	}
     }
     /*
      *  SSPIF signals next byte from MSSP (SPI)
@@ -167,12 +200,53 @@ void    InterruptHandlerHigh(void) INTERRUPT
 	     * section as possible as opposed to other parts of the
 	     * ISR.
 	     */
+	    if ( Latency_enabled )
+		TIMER0_READ16(Latency_rx_time);
+	    
+	    /*
+	     *  Link statistics.  The master numbers its packets, so a
+	     *  jump of more than one means packets were lost.  SSPOV and
+	     *  WCOL are sticky, so checking once per packet is enough.
+	     */
+	    rx_packet_num = Rx_buff[!Rx_user_buff_index].packet_num;
+	    if ( Link_stats.frames != 0 )
+	    {
+		if ( rx_packet_num == last_rx_packet_num )
+		    ++Link_stats.duplicate_packets;
+		else
+		    Link_stats.missed_packets +=
+			(unsigned char)(rx_packet_num - last_rx_packet_num - 1);
+	    }
+	    last_rx_packet_num = rx_packet_num;
+	    ++Link_stats.frames;
+	    if ( SSPCON1bits.SSPOV )
+	    {
+		SSPCON1bits.SSPOV = 0;
+		++Link_stats.overflows;
+	    }
+	    if ( SSPCON1bits.WCOL )
+	    {
+		SSPCON1bits.WCOL = 0;
+		++Link_stats.collisions;
+	    }
+	    /* User code never called rc_new_data_available() for last one */
+	    if ( Spi_status.new_rc_data )
+		++Link_stats.user_missed;
+	    
 	    /* Initialized to one.  2 means this is not the first packet. */
 	    User_txdata.current_mode = 2;
 	    Spi_status.new_tx_data = 0;
+	    Spi_status.receiving = 0;
+	    ++Spi_rx_packets;
 	    MASTER_SET_NEW_RC_DATA_FLAG(Spi_status);
 	    Rx_user_buff_index = !Rx_user_buff_index;
 	    User_rxdata = Rx_buff + Rx_user_buff_index;
+	    
+	    /*
+	     *  Software interrupt for the frame callback, if any.  It
+	     *  runs as soon as this ISR returns.  See interrupts.c.
+	     */
+	    PIR1bits.CCP1IF = 1;
 	}
 	//  This appears to serve no purpose, but I'm not 100% sure.
 	//  If someone put it here, they must have thought it was necessary.
@@ -281,13 +355,19 @@ void    user_proc_is_ready(void)
 
 void    check_tx_env(void)
 {
+    static unsigned char    reported_collisions = 0;
+    
     User_txdata.error_code = 0;
     User_txdata.warning_code = 0;
 
-    /* Check for SPI write collision */
-    if (SSPCON1bits.WCOL)
+    /*
+     *  Check for SPI write collision.  The SPI ISR clears WCOL and
+     *  counts it in Link_stats, so report any new ones since last time.
+     *  Comparing only the low byte avoids a torn read of the counter.
+     */
+    if ((unsigned char)Link_stats.collisions != reported_collisions)
     {
-	SSPCON1bits.WCOL = 0;
+	reported_collisions = (unsigned char)Link_stats.collisions;
 	User_txdata.warning_code = 1;
     }
     /* Check if PORTB pull-ups and RB interrupts are enabled */
@@ -62,7 +62,8 @@ typedef struct
     unsigned char new_rc_data:1;
     unsigned char new_tx_data:1;
     unsigned char first_time:1;
-    unsigned char:2;
+    unsigned char receiving:1;      /* Between INT0 and the last byte */
+    unsigned char:1;
     unsigned char semaphore:1;
     unsigned char:2;
 }   spi_status_t;
@@ -70,11 +71,12 @@ typedef struct
 
 extern volatile rx_data_t      Rx_buff[2];
 extern volatile unsigned char  Rx_user_buff_index;
-extern volatile rx_data_t      *User_rxdata;
+extern volatile rx_data_t      * volatile User_rxdata;
 extern volatile tx_data_t      Tx_buff[2];
 extern volatile unsigned char  Tx_user_buff_index;
 extern tx_data_t               User_txdata;
 extern volatile spi_status_t   Spi_status;
+extern volatile unsigned char  Spi_rx_packets;
 
 /* spi.c */
 void user_proc_is_ready(void);